@@ -1,7 +1,12 @@
 #pragma once
 
 #include "compilation/environment.h"
+#include "ast/node_arena.h"
+#include <algorithm>
 #include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
 
 namespace dconstruct::ast {
 
@@ -38,16 +43,21 @@ namespace dconstruct::ast {
 
     struct ast_element {
         virtual ~ast_element() = default;
+
+        [[nodiscard]] static void* operator new(const std::size_t size) {
+            return node_arena::allocate_node(size);
+        }
+
+        static void operator delete(void* node) noexcept {
+            node_arena::free_node(node);
+        }
+
         virtual void pseudo_c(std::ostream&) const = 0;
         virtual void pseudo_py(std::ostream&) const = 0;
         virtual void pseudo_racket(std::ostream&) const = 0;
         virtual bool is_dead_code() const noexcept { return false; }
 
-        [[nodiscard]] std::string to_c_string() const noexcept {
-            std::ostringstream oss;
-            pseudo_c(oss);
-            return oss.str();
-        }
+        [[nodiscard]] std::string to_c_string() const noexcept;
     };
 
     enum class LANGUAGE_FLAGS {
@@ -109,9 +119,12 @@ namespace dconstruct::ast {
     }
 
     inline std::ostream& indent(std::ostream& os) {
-        int level = os.iword(indent_index());
-        for (int i = 0; i < level; ++i) {
-            os << "    ";
+        static const std::string spaces(256, ' ');
+        const long level = os.iword(indent_index());
+        for (std::size_t width = level > 0 ? level * 4 : 0; width > 0;) {
+            const std::size_t count = std::min(width, spaces.size());
+            os.write(spaces.data(), count);
+            width -= count;
         }
         return os;
     }
@@ -128,4 +141,82 @@ namespace dconstruct::ast {
     }
 
     using print_fn_type = std::ostream& (*)(std::ostream&);
+
+    struct print_options {
+        // c when not set
+        print_fn_type m_language = nullptr;
+        bool m_functionNamesPascal = false;
+    };
+
+    // collects printed code in one string and hands it to the real output in a single write.
+    // the ast printers take a std::ostream, so this is one, but every write is a plain append.
+    class code_writer : public std::ostream {
+    public:
+        static constexpr std::size_t default_reserve = 256 * 1024;
+
+        explicit code_writer(const std::size_t reserve = default_reserve) : std::ostream(nullptr) {
+            m_buffer.m_text.reserve(reserve);
+            rdbuf(&m_buffer);
+        }
+
+        explicit code_writer(const print_options& options, const std::size_t reserve = default_reserve) : code_writer(reserve) {
+            apply(options);
+        }
+
+        code_writer(const code_writer&) = delete;
+        code_writer& operator=(const code_writer&) = delete;
+
+        // replaces the language and naming flags, so one writer can render the same tree several ways
+        void apply(const print_options& options) {
+            iword(get_flag_index()) = 0;
+            if (options.m_language) {
+                *this << options.m_language;
+            }
+            if (options.m_functionNamesPascal) {
+                *this << func_pascal_case;
+            }
+        }
+
+        [[nodiscard]] std::string_view view() const noexcept {
+            return m_buffer.m_text;
+        }
+
+        [[nodiscard]] std::string take() noexcept {
+            return std::move(m_buffer.m_text);
+        }
+
+        void clear() noexcept {
+            m_buffer.m_text.clear();
+        }
+
+        void flush_to(std::ostream& os) {
+            os.write(m_buffer.m_text.data(), static_cast<std::streamsize>(m_buffer.m_text.size()));
+            clear();
+        }
+
+    private:
+        struct string_buffer : public std::streambuf {
+            int_type overflow(const int_type ch) final {
+                if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+                    m_text.push_back(traits_type::to_char_type(ch));
+                }
+                return traits_type::not_eof(ch);
+            }
+
+            std::streamsize xsputn(const char* s, const std::streamsize count) final {
+                m_text.append(s, static_cast<std::size_t>(count));
+                return count;
+            }
+
+            std::string m_text;
+        };
+
+        string_buffer m_buffer;
+    };
+
+    [[nodiscard]] inline std::string ast_element::to_c_string() const noexcept {
+        code_writer os{ 256 };
+        pseudo_c(os);
+        return os.take();
+    }
 }
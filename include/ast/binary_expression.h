@@ -21,10 +21,21 @@ namespace dconstruct::ast {
             return expr;
         }
 
+        void serialize(ast_writer& writer) const final {
+            writer.write(impl_binary_expr::node_kind);
+            writer.write(m_operator);
+            writer.write(m_lhs);
+            writer.write(m_rhs);
+        }
+
         [[nodiscard]] expr_uptr get_grouped() const {
             return std::make_unique<ast::grouping>(clone());
         }
 
+        [[nodiscard]] bool needs_grouping() const noexcept final {
+            return true;
+        }
+
         inline VAR_OPTIMIZATION_ACTION var_optimization_pass(var_optimization_env& env) noexcept final {
             env.check_action(&m_lhs);
             env.check_action(&m_rhs);
@@ -5,6 +5,7 @@
 
 namespace dconstruct::ast {
     struct add_expr : public clonable_binary_expr<add_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::ADD;
         using clonable_binary_expr::clonable_binary_expr;
 
         explicit add_expr(expr_uptr&& lhs, expr_uptr&& rhs) noexcept : clonable_binary_expr(compilation::token{ compilation::token_type::PLUS, "+" }, std::move(lhs), std::move(rhs)) {};
@@ -5,6 +5,7 @@
 
 namespace dconstruct::ast {
     struct bitwise_and_expr : public clonable_binary_expr<bitwise_and_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::BITWISE_AND;
         using clonable_binary_expr::clonable_binary_expr;
 
 
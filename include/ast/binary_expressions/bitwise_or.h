@@ -5,6 +5,7 @@
 
 namespace dconstruct::ast {
     struct bitwise_or_expr : public clonable_binary_expr<bitwise_or_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::BITWISE_OR;
         using clonable_binary_expr::clonable_binary_expr;
 
         explicit bitwise_or_expr(expr_uptr&& lhs, expr_uptr&& rhs) noexcept : clonable_binary_expr(compilation::token{ compilation::token_type::PIPE, "|" }, std::move(lhs), std::move(rhs)) {};
@@ -5,6 +5,7 @@
 
 namespace dconstruct::ast {
     struct bitwise_xor_expr : public clonable_binary_expr<bitwise_xor_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::BITWISE_XOR;
         using clonable_binary_expr::clonable_binary_expr;
 
         explicit bitwise_xor_expr(expr_uptr&& lhs, expr_uptr&& rhs) noexcept : clonable_binary_expr(compilation::token{ compilation::token_type::CARET, "^" }, std::move(lhs), std::move(rhs)) {};
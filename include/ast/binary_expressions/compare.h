@@ -5,6 +5,7 @@
 
 namespace dconstruct::ast {
     struct compare_expr : public clonable_binary_expr<compare_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::COMPARE;
         using clonable_binary_expr::clonable_binary_expr;
 
         [[nodiscard]] expr_uptr simplify() const final;
@@ -4,6 +4,7 @@
 
 namespace dconstruct::ast {
     struct div_expr : public clonable_binary_expr<div_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::DIV;
         using clonable_binary_expr::clonable_binary_expr;
 
         explicit div_expr(expr_uptr&& lhs, expr_uptr&& rhs) noexcept : clonable_binary_expr(compilation::token{ compilation::token_type::SLASH, "/" }, std::move(lhs), std::move(rhs)) {};
@@ -4,6 +4,7 @@
 
 namespace dconstruct::ast {
     struct logical_expr : public clonable_binary_expr<logical_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::LOGICAL;
         using clonable_binary_expr::clonable_binary_expr;
         [[nodiscard]] expr_uptr simplify() const final;
 
@@ -4,6 +4,7 @@
 
 namespace dconstruct::ast {
     struct mod_expr : public clonable_binary_expr<mod_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::MOD;
         using clonable_binary_expr::clonable_binary_expr;
 
         explicit mod_expr(expr_uptr&& lhs, expr_uptr&& rhs) noexcept : clonable_binary_expr(compilation::token{ compilation::token_type::PERCENT, "%" }, std::move(lhs), std::move(rhs)) {};
@@ -5,6 +5,7 @@
 
 namespace dconstruct::ast {
     struct mul_expr : public clonable_binary_expr<mul_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::MUL;
         using clonable_binary_expr::clonable_binary_expr;
 
         explicit mul_expr(expr_uptr&& lhs, expr_uptr&& rhs) noexcept : clonable_binary_expr(compilation::token{ compilation::token_type::STAR, "*" }, std::move(lhs), std::move(rhs)) {};
@@ -5,6 +5,7 @@
 
 namespace dconstruct::ast {
     struct shift_expr : public clonable_binary_expr<shift_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::SHIFT;
         using clonable_binary_expr::clonable_binary_expr;
 
         explicit shift_expr(expr_uptr&& lhs, expr_uptr&& rhs) noexcept : clonable_binary_expr(compilation::token{ compilation::token_type::GREATER_GREATER, ">>" }, std::move(lhs), std::move(rhs)) {};
@@ -4,6 +4,7 @@
 
 namespace dconstruct::ast { 
     struct sub_expr : public clonable_binary_expr<sub_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::SUB;
         using clonable_binary_expr::clonable_binary_expr;
 
         explicit sub_expr(expr_uptr&& lhs, expr_uptr&& rhs) noexcept : clonable_binary_expr(compilation::token{ compilation::token_type::MINUS, "-" }, std::move(lhs), std::move(rhs)) {};
@@ -7,6 +7,7 @@
 #include "compilation/environment.h"
 #include "compilation/function.h"
 #include "compilation/global_state.h"
+#include "ast/serialization.h"
 #include <ostream>
 #include <vector>
 #include "llvm/IR/Value.h"
@@ -61,9 +62,14 @@ namespace dconstruct::ast {
         [[nodiscard]] virtual std::unique_ptr<expression> simplify() const = 0;
         [[nodiscard]] virtual bool equals(const expression& other) const noexcept = 0;
         [[nodiscard]] virtual std::unique_ptr<expression> clone() const = 0;
+        virtual void serialize(ast_writer& writer) const = 0;
         [[nodiscard]] virtual std::unique_ptr<expression> get_grouped() const {
             return clone();
         }
+        // whether get_grouped wraps the expression instead of just copying it
+        [[nodiscard]] virtual bool needs_grouping() const noexcept {
+            return false;
+        }
         [[nodiscard]] virtual llvm_res emit_llvm(llvm::LLVMContext&, llvm::IRBuilder<>&, llvm::Module&, const compilation::scope&) const {
             return std::unexpected{llvm_error{"not implemented", *this}};
         };
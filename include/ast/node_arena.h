@@ -0,0 +1,161 @@
+#pragma once
+
+#include "base.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace dconstruct::ast {
+
+    // bump allocator for ast nodes. nodes are still destroyed through their owning pointers,
+    // but their memory is only handed back in one go when the arena is reset.
+    // an arena is strictly thread local: a thread owns at most one, and the arena's nodes are freed on that thread.
+    // that's how a freed node is told apart from a heap node without a header, it's the arena's if it lies in one of its blocks.
+    class node_arena {
+    public:
+        static constexpr std::size_t default_block_size = 64 * 1024;
+
+        // sets the arena that new ast nodes on this thread are allocated from, restores the previous one on exit
+        struct scope {
+            explicit scope(node_arena& arena) noexcept : m_previous(std::exchange(current(), &arena)) {}
+            // allocates from the heap instead, for nodes that have to outlive the current arena
+            explicit scope(std::nullptr_t) noexcept : m_previous(std::exchange(current(), nullptr)) {}
+            ~scope() noexcept { current() = m_previous; }
+
+            scope(const scope&) = delete;
+            scope& operator=(const scope&) = delete;
+
+            node_arena* m_previous;
+        };
+
+        explicit node_arena(const std::size_t block_size = default_block_size) : m_blockSize(block_size) {
+            if (owner()) {
+                throw std::runtime_error("this thread already has a node arena");
+            }
+            owner() = this;
+        }
+
+        node_arena(const node_arena&) = delete;
+        node_arena& operator=(const node_arena&) = delete;
+
+        ~node_arena() noexcept {
+            if (m_liveNodes != 0) {
+                std::cerr << m_liveNodes << " ast nodes outlived their arena\n";
+                std::terminate();
+            }
+            owner() = nullptr;
+        }
+
+        [[nodiscard]] void* allocate(std::size_t size) {
+            size = align_up(size);
+            if (m_current == m_blocks.size() || m_used + size > m_blocks[m_current].m_size) {
+                next_block(size);
+            }
+            void* res = m_blocks[m_current].m_data.get() + m_used;
+            m_used += size;
+            ++m_liveNodes;
+            return res;
+        }
+
+        void deallocate() noexcept {
+            --m_liveNodes;
+        }
+
+        // keeps the blocks around for the next batch of nodes
+        void reset() {
+            if (m_liveNodes != 0) {
+                throw std::runtime_error("resetting a node arena with " + std::to_string(m_liveNodes) + " live ast nodes");
+            }
+            m_current = 0;
+            m_used = 0;
+        }
+
+        [[nodiscard]] bool owns(const void* ptr) const noexcept {
+            const auto* byte_ptr = static_cast<const std::byte*>(ptr);
+            auto it = std::upper_bound(m_blockRanges.begin(), m_blockRanges.end(), byte_ptr, [](const std::byte* p, const block_range& range) {
+                return std::less<const std::byte*>{}(p, range.m_begin);
+            });
+            if (it == m_blockRanges.begin()) {
+                return false;
+            }
+            --it;
+            return std::less<const std::byte*>{}(byte_ptr, it->m_end);
+        }
+
+        [[nodiscard]] static node_arena*& current() noexcept {
+            thread_local node_arena* arena = nullptr;
+            return arena;
+        }
+
+        // the arena of this thread, whether or not its scope is active
+        [[nodiscard]] static node_arena*& owner() noexcept {
+            thread_local node_arena* arena = nullptr;
+            return arena;
+        }
+
+        [[nodiscard]] static void* allocate_node(const std::size_t size) {
+            node_arena* arena = current();
+            return arena ? arena->allocate(size) : ::operator new(size);
+        }
+
+        static void free_node(void* node) noexcept {
+            if (!node) {
+                return;
+            }
+            node_arena* arena = owner();
+            if (arena && arena->owns(node)) {
+                arena->deallocate();
+            } else {
+                ::operator delete(node);
+            }
+        }
+
+    private:
+        struct block {
+            std::unique_ptr<std::byte[]> m_data;
+            std::size_t m_size;
+        };
+
+        struct block_range {
+            const std::byte* m_begin;
+            const std::byte* m_end;
+        };
+
+        [[nodiscard]] static constexpr std::size_t align_up(const std::size_t size) noexcept {
+            return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        }
+
+        void next_block(const std::size_t size) {
+            if (m_current != m_blocks.size()) {
+                ++m_current;
+            }
+            while (m_current < m_blocks.size() && m_blocks[m_current].m_size < size) {
+                ++m_current;
+            }
+            if (m_current == m_blocks.size()) {
+                const std::size_t block_size = std::max(size, m_blockSize);
+                const block& added = m_blocks.emplace_back(block{ std::make_unique_for_overwrite<std::byte[]>(block_size), block_size });
+                const block_range range{ added.m_data.get(), added.m_data.get() + block_size };
+                const auto at = std::upper_bound(m_blockRanges.begin(), m_blockRanges.end(), range.m_begin, [](const std::byte* p, const block_range& other) {
+                    return std::less<const std::byte*>{}(p, other.m_begin);
+                });
+                m_blockRanges.insert(at, range);
+            }
+            m_used = 0;
+        }
+
+        std::vector<block> m_blocks;
+        // the blocks sorted by address, for owns()
+        std::vector<block_range> m_blockRanges;
+        std::size_t m_blockSize;
+        std::size_t m_current = 0;
+        std::size_t m_used = 0;
+        std::size_t m_liveNodes = 0;
+    };
+}
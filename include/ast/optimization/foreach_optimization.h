@@ -10,6 +10,7 @@ namespace dconstruct::ast {
         std::vector<std::variant<std::unique_ptr<statement>*, std::unique_ptr<expression>*>> m_iterableAt;
         //std::vector<std::variant<std::unique_ptr<statement>*, std::unique_ptr<expression>*>> m_iterableCount;
         std::vector<std::unique_ptr<statement>*> m_for;
+        bool m_changed = false;
 
         void check_action(std::unique_ptr<expression>* expr);
         void check_action(std::unique_ptr<statement>* stmt);
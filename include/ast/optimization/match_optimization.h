@@ -17,5 +17,6 @@ namespace dconstruct::ast {
         std::vector<std::unique_ptr<expression>*> m_matches;
         bool m_checkingCondition;
         u16 m_currentAssignIdx;
+        bool m_changed = false;
     };
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "base.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+
+namespace dconstruct::ast {
+
+    enum class OPTIMIZATION_PASS : u8 {
+        VAR,
+        FOREACH,
+        MATCH,
+        VAR_CLEANUP,
+        COUNT,
+    };
+
+    // accumulated over every function decompiled in the process, safe to update from worker threads
+    struct optimization_stats {
+        static constexpr u8 pass_count = static_cast<u8>(OPTIMIZATION_PASS::COUNT);
+        static constexpr const char* pass_names[pass_count] = { "var", "foreach", "match", "var cleanup" };
+
+        std::array<std::atomic<u64>, pass_count> m_nanoseconds{};
+        std::array<std::atomic<u64>, pass_count> m_runs{};
+        std::array<std::atomic<u64>, pass_count> m_changedRuns{};
+        std::array<std::atomic<u64>, pass_count> m_skippedRuns{};
+
+        // runs the pass and returns whether it changed the tree
+        template <typename pass_fn>
+        bool time_pass(const OPTIMIZATION_PASS pass, pass_fn&& run) {
+            const u8 idx = static_cast<u8>(pass);
+            const auto start = std::chrono::high_resolution_clock::now();
+            const bool changed = run();
+            const auto stop = std::chrono::high_resolution_clock::now();
+            m_nanoseconds[idx] += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+            ++m_runs[idx];
+            if (changed) {
+                ++m_changedRuns[idx];
+            }
+            return changed;
+        }
+
+        void skip_pass(const OPTIMIZATION_PASS pass) noexcept {
+            ++m_skippedRuns[static_cast<u8>(pass)];
+        }
+
+        void print(std::ostream& os) const {
+            for (u8 i = 0; i < pass_count; ++i) {
+                os << pass_names[i] << ": " << m_runs[i] << " runs (" << m_changedRuns[i] << " changed, "
+                   << m_skippedRuns[i] << " skipped) in " << m_nanoseconds[i] / 1'000'000 << "ms\n";
+            }
+        }
+    };
+
+    inline optimization_stats g_optimizationStats;
+}
@@ -18,9 +18,8 @@ namespace dconstruct::ast {
     struct var_optimization_env {
         compilation::environment<variable_folding_context> m_env;
         bool m_isLvalueDereference = false;
-
-        explicit var_optimization_env(compilation::environment<variable_folding_context>* enclosing = nullptr) noexcept
-            : m_env(enclosing) {}
+        // set when the pass rewrote anything in this scope or a nested one
+        bool m_changed = false;
 
         void check_action(std::unique_ptr<expression>* expr);
         void check_action(std::unique_ptr<statement>* stmt);
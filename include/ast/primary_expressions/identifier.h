@@ -18,6 +18,7 @@ namespace dconstruct::ast {
         [[nodiscard]] expr_uptr simplify() const final;
         [[nodiscard]] bool equals(const expression &rhs) const noexcept final;
         [[nodiscard]] expr_uptr clone() const final;
+        void serialize(ast_writer& writer) const final;
         [[nodiscard]] full_type compute_type_unchecked(const compilation::scope& env) const noexcept final { return std::monostate(); }
         [[nodiscard]] semantic_check_res compute_type_checked(compilation::scope& env) const noexcept final;
         [[nodiscard]] u16 calc_complexity() const noexcept final;
@@ -23,6 +23,8 @@ namespace dconstruct::ast {
 
         [[nodiscard]] expr_uptr clone() const noexcept final;
 
+        void serialize(ast_writer& writer) const final;
+
         [[nodiscard]] u16 calc_complexity() const noexcept final;
 
         [[nodiscard]] inline full_type compute_type_unchecked(const compilation::scope& env) const noexcept final;
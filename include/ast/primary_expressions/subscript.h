@@ -15,6 +15,7 @@ namespace dconstruct::ast {
         [[nodiscard]] full_type compute_type_unchecked(const compilation::scope& env) const noexcept final;
         [[nodiscard]] semantic_check_res compute_type_checked(compilation::scope& env) const noexcept final;
         [[nodiscard]] expr_uptr clone() const noexcept final;   
+        void serialize(ast_writer& writer) const final;
         [[nodiscard]] bool equals(const expression& other) const noexcept final;
         [[nodiscard]] u16 calc_complexity() const noexcept final;
         [[nodiscard]] bool is_l_evaluable() const noexcept final { return true; }
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "base.h"
+#include "ast/type.h"
+#include "compilation/tokens.h"
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace dconstruct::ast {
+
+    struct expression;
+    struct statement;
+    struct function_definition;
+
+    enum class NODE_KIND : u8 {
+        NONE,
+
+        ASSIGN,
+        CAST,
+        CALL,
+        GROUPING,
+        IDENTIFIER,
+        LITERAL,
+        MATCH,
+        SIZEOF,
+        SUBSCRIPT,
+        TERNARY,
+
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        MOD,
+        SHIFT,
+        COMPARE,
+        LOGICAL,
+        BITWISE_AND,
+        BITWISE_OR,
+        BITWISE_XOR,
+
+        NEGATE,
+        BITWISE_NOT,
+        DEREFERENCE,
+        LOGICAL_NOT,
+        POST_ARITHMETIC,
+
+        BLOCK,
+        EXPRESSION_STMT,
+        FOR,
+        FOREACH,
+        IF,
+        WHILE,
+        RETURN,
+        VARIABLE_DECLARATION,
+        BREAKPOINT,
+
+        COUNT,
+    };
+
+    template <typename T>
+    concept serializable_scalar = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+    // flat binary form of decompiled asts. nodes write their kind and fields through serialize(),
+    // ast_reader rebuilds them with their regular constructors.
+    class ast_writer {
+    public:
+        template <serializable_scalar T>
+        void write(const T value) {
+            const std::size_t offset = m_data.size();
+            m_data.resize(offset + sizeof(T));
+            std::memcpy(m_data.data() + offset, &value, sizeof(T));
+        }
+
+        void write(const std::string& str);
+        void write(const compilation::token& token);
+        void write(const full_type& type);
+        void write(const ref_full_type& type);
+        void write(const primitive_value& value);
+        // also writes the cached type, so printing doesn't need the scope it was computed in
+        void write(const expression* expr);
+        void write(const std::unique_ptr<expression>& expr) { write(expr.get()); }
+        void write(const statement* stmt);
+        void write(const std::unique_ptr<statement>& stmt) { write(stmt.get()); }
+        void write(const function_definition& func);
+
+        template <typename T>
+        void write(const std::vector<T>& values) {
+            write(static_cast<u32>(values.size()));
+            for (const auto& value : values) {
+                write(value);
+            }
+        }
+
+        [[nodiscard]] const std::vector<std::byte>& data() const noexcept {
+            return m_data;
+        }
+
+    private:
+        std::vector<std::byte> m_data;
+    };
+
+    // reads what ast_writer wrote. running past the end or hitting an unknown node marks the reader as failed,
+    // after which it only returns empty values, so callers check failed() once at the end.
+    class ast_reader {
+    public:
+        explicit ast_reader(const std::span<const std::byte> data) noexcept : m_data(data) {}
+
+        template <serializable_scalar T>
+        [[nodiscard]] T read() noexcept {
+            T value{};
+            if (m_offset + sizeof(T) > m_data.size()) {
+                m_failed = true;
+                return value;
+            }
+            std::memcpy(&value, m_data.data() + m_offset, sizeof(T));
+            m_offset += sizeof(T);
+            return value;
+        }
+
+        [[nodiscard]] std::string read_string();
+        [[nodiscard]] compilation::token read_token();
+        [[nodiscard]] full_type read_type();
+        [[nodiscard]] ref_full_type read_ref_type();
+        [[nodiscard]] primitive_value read_primitive();
+        [[nodiscard]] std::unique_ptr<expression> read_expression();
+        [[nodiscard]] std::unique_ptr<statement> read_statement();
+        [[nodiscard]] function_definition read_function();
+
+        [[nodiscard]] u32 read_count() noexcept {
+            const u32 count = read<u32>();
+            // every element takes at least a byte, anything larger is a corrupt count
+            if (count > m_data.size() - m_offset) {
+                m_failed = true;
+                return 0;
+            }
+            return count;
+        }
+
+        [[nodiscard]] bool failed() const noexcept {
+            return m_failed;
+        }
+
+        [[nodiscard]] bool at_end() const noexcept {
+            return m_offset == m_data.size();
+        }
+
+    private:
+        std::span<const std::byte> m_data;
+        std::size_t m_offset = 0;
+        bool m_failed = false;
+    };
+}
@@ -16,6 +16,7 @@ namespace dconstruct::ast {
         virtual FOREACH_OPTIMIZATION_ACTION foreach_optimization_pass(foreach_optimization_env& optimization_env) noexcept { return FOREACH_OPTIMIZATION_ACTION::NONE; }
         virtual MATCH_OPTIMIZATION_ACTION match_optimization_pass(match_optimization_env& optimization_env) noexcept { return MATCH_OPTIMIZATION_ACTION::NONE; }
         [[nodiscard]] virtual std::unique_ptr<statement> clone() const noexcept = 0;
+        virtual void serialize(ast_writer& writer) const = 0;
         [[nodiscard]] virtual const statement* inlineable_else_statement() const noexcept { return nullptr; }
         [[nodiscard]] virtual std::vector<semantic_check_error> check_semantics(compilation::scope& env) const noexcept = 0;
         [[nodiscard]] virtual emission_err emit_dc(compilation::function& fn, compilation::global_state& gen) const noexcept { return "not implmenented"; };
@@ -13,6 +13,7 @@ namespace dconstruct::ast {
 		void pseudo_racket(std::ostream&) const final;
         [[nodiscard]] bool equals(const statement& rhs) const noexcept final;
         [[nodiscard]] std::unique_ptr<statement> clone() const noexcept final;
+        void serialize(ast_writer& writer) const final;
         [[nodiscard]] bool is_dead_code() const noexcept override;
         [[nodiscard]] std::vector<semantic_check_error> check_semantics(compilation::scope& env) const noexcept override;
         [[nodiscard]] emission_err emit_dc(compilation::function& fn, compilation::global_state& global) const noexcept final;
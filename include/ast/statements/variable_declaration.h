@@ -11,13 +11,13 @@ namespace dconstruct::ast {
     struct variable_declaration : public statement {
 
         explicit variable_declaration(ast::full_type type, std::string id_name) noexcept :
-        m_type(std::move(type)), m_identifier(std::move(id_name)), m_init(nullptr) {}; 
+        m_type(std::move(type)), m_identifier(std::move(id_name)), m_symbol(compilation::symbol_table::intern(m_identifier)), m_init(nullptr) {}; 
 
         explicit variable_declaration(ast::full_type type, std::string id_name, expr_uptr&& init) noexcept :
-        m_type(std::move(type)), m_identifier(std::move(id_name)), m_init(std::move(init)) {}; 
+        m_type(std::move(type)), m_identifier(std::move(id_name)), m_symbol(compilation::symbol_table::intern(m_identifier)), m_init(std::move(init)) {}; 
 
         explicit variable_declaration(ast::full_type type, std::string id_name, const ast::primitive_value& init) noexcept :
-        m_type(std::move(type)), m_identifier(std::move(id_name)), m_init(std::make_unique<ast::literal>(init)) {};
+        m_type(std::move(type)), m_identifier(std::move(id_name)), m_symbol(compilation::symbol_table::intern(m_identifier)), m_init(std::make_unique<ast::literal>(init)) {};
 
         [[nodiscard]] std::vector<semantic_check_error> check_semantics(compilation::scope& env) const noexcept final;
         [[nodiscard]] emission_err emit_dc(compilation::function& fn, compilation::global_state& global) const noexcept final;
@@ -36,12 +36,15 @@ namespace dconstruct::ast {
 
         [[nodiscard]] std::unique_ptr<statement> clone() const noexcept final;
 
+        void serialize(ast_writer& writer) const final;
+
         [[nodiscard]] inline const expression* get_init_ptr() const noexcept {
             return m_init.get();
         } 
 
         ast::full_type m_type;
         std::string m_identifier;
+        compilation::symbol_id m_symbol;
         expr_uptr m_init;
     };
 
@@ -15,6 +15,8 @@ namespace dconstruct::ast {
         [[nodiscard]] bool equals(const statement& rhs) const noexcept final;
 
         [[nodiscard]] std::unique_ptr<statement> clone() const noexcept final;
+
+        void serialize(ast_writer& writer) const final;
         [[nodiscard]] std::vector<semantic_check_error> check_semantics(compilation::scope& env) const noexcept final;
         [[nodiscard]] emission_err emit_dc(compilation::function& fn, compilation::global_state& global) const noexcept final;
 
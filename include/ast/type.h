@@ -113,6 +113,10 @@ namespace dconstruct::ast {
 
     [[nodiscard]] full_type make_type_from_prim(const primitive_kind kind);
 
+    // returns this thread's shared node for the type, so types interned on the same thread compare equal by pointer.
+    // interned nodes are shared between everything that uses the type and must never be written through.
+    [[nodiscard]] ref_full_type intern_type(const full_type& type);
+
     [[nodiscard]] bool is_unknown(const full_type& type) noexcept;
 
     [[nodiscard]] bool is_signed(const full_type& type) noexcept; 
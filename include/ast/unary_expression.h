@@ -18,6 +18,12 @@ namespace dconstruct::ast {
             return expr;
         }
 
+        void serialize(ast_writer& writer) const final {
+            writer.write(impl_unary_expr::node_kind);
+            writer.write(m_operator);
+            writer.write(m_rhs);
+        }
+
         inline VAR_OPTIMIZATION_ACTION var_optimization_pass(var_optimization_env& env) noexcept override {
             env.check_action(&m_rhs);
             return VAR_OPTIMIZATION_ACTION::NONE;
@@ -4,6 +4,7 @@
 
 namespace dconstruct::ast {
     struct bitwise_not_expr : public clonable_unary_expr<bitwise_not_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::BITWISE_NOT;
         using clonable_unary_expr::clonable_unary_expr;
         
         explicit bitwise_not_expr(expr_uptr&& rhs) noexcept : clonable_unary_expr(compilation::token{ compilation::token_type::TILDE, "~" }, std::move(rhs)) {};
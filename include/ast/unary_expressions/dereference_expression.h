@@ -4,6 +4,7 @@
 
 namespace dconstruct::ast {
     struct dereference_expr : public clonable_unary_expr<dereference_expr>{
+        static constexpr NODE_KIND node_kind = NODE_KIND::DEREFERENCE;
         using clonable_unary_expr::clonable_unary_expr;
 
         explicit dereference_expr(expr_uptr&& rhs) noexcept : clonable_unary_expr(compilation::token{ compilation::token_type::STAR, "*" }, std::move(rhs)) {};
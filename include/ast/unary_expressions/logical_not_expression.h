@@ -4,6 +4,7 @@
 
 namespace dconstruct::ast {
     struct logical_not_expr : public clonable_unary_expr<logical_not_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::LOGICAL_NOT;
         using clonable_unary_expr::clonable_unary_expr;
         
         explicit logical_not_expr(expr_uptr&& rhs) noexcept : clonable_unary_expr(compilation::token{ compilation::token_type::BANG, "!" }, std::move(rhs)) {};
@@ -5,6 +5,7 @@
 
 namespace dconstruct::ast {
     struct negate_expr : public clonable_unary_expr<negate_expr> {
+        static constexpr NODE_KIND node_kind = NODE_KIND::NEGATE;
         using clonable_unary_expr::clonable_unary_expr;
         
         explicit negate_expr(expr_uptr&& rhs) noexcept : clonable_unary_expr(compilation::token{ compilation::token_type::MINUS, "-" }, std::move(rhs)) {};
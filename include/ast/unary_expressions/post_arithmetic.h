@@ -4,6 +4,7 @@
 
 namespace dconstruct::ast {
     struct post_arithmetic_expression : public clonable_unary_expr<post_arithmetic_expression>{
+        static constexpr NODE_KIND node_kind = NODE_KIND::POST_ARITHMETIC;
         using clonable_unary_expr::clonable_unary_expr;
 
         explicit post_arithmetic_expression(expr_uptr&& rhs) noexcept : clonable_unary_expr(compilation::token{ compilation::token_type::PLUS_PLUS, "++" }, std::move(rhs)) {};
@@ -12,6 +12,9 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <optional>
+#include <span>
 
 namespace dconstruct {
     enum class symbol_type {
@@ -38,6 +41,35 @@ namespace dconstruct {
         };
     };
 
+    struct struct_table_entry {
+        u32 m_offset;
+        u32 m_size;
+        sid64 m_typeId;
+        u32 m_firstPointerSlot;
+        u32 m_numPointerSlots;
+        u32 m_firstReferrer;
+        u32 m_numReferrers;
+    };
+
+    // every pointed-at location in the data segment, sorted by offset. m_size runs up to the next pointed-at
+    // header or the string table, m_typeId is 0 if the location isn't preceded by a type ID (anonymous arrays etc.).
+    // pointer slots and referrers are file offsets, stored contiguously per entry.
+    struct struct_table {
+        std::vector<struct_table_entry> m_entries;
+        std::vector<u32> m_pointerSlots;
+        std::vector<u32> m_referrers;
+
+        [[nodiscard]] const struct_table_entry* find(const u32 offset) const noexcept;
+        [[nodiscard]] std::span<const u32> pointer_slots(const struct_table_entry& entry) const noexcept;
+        [[nodiscard]] std::span<const u32> referrers(const struct_table_entry& entry) const noexcept;
+    };
+
+    struct emitted_content {
+        u32 m_offset;
+        u32 m_size;
+        u32 m_numElements;
+    };
+
     class BinaryFile
     {
     public:
@@ -56,10 +88,25 @@ namespace dconstruct {
         location m_strings;
         location m_relocTable;
         std::map<sid64, const std::string> m_sidCache;
-        std::set<p64> m_emittedStructs;
+        std::unique_ptr<std::byte[]> m_emittedTable;
+        std::unordered_multimap<u64, emitted_content> m_emittedContents;
+        struct_table m_structs;
         [[nodiscard]] bool is_file_ptr(const location) const noexcept;
         [[nodiscard]] bool gets_pointed_at(const location) const noexcept;
         [[nodiscard]] bool is_string(const location) const noexcept;
+        [[nodiscard]] const struct_table_entry* get_struct(const location) const noexcept;
+        // bytes covered by an array that starts at the entry. the entry's size, unless nothing with a type ID
+        // follows it before the string table, then the array also covers the qword the string table starts in.
+        [[nodiscard]] u32 get_array_size(const struct_table_entry&) const noexcept;
+        [[nodiscard]] bool is_emitted(const location) const noexcept;
+        void set_emitted(const location) noexcept;
+        [[nodiscard]] std::optional<u32> find_emitted_content(const location, const u32 size, const u32 num_elements = 0) const noexcept;
+        void add_emitted_content(const location, const u32 size, const u32 num_elements = 0);
+        // 4 byte aligned offsets of value, in ascending order. files of at least FIND_U32_MIN_BYTES_PER_THREAD bytes per thread are split
+        // across up to max_threads threads, callers that already run on a worker of a batch keep the default of searching on their own thread
+        [[nodiscard]] std::vector<u64> find_u32(const u32 value, const u32 max_threads = 1) const;
+        static constexpr u64 FIND_U32_MIN_BYTES_PER_THREAD = 0x400000;
+        void build_struct_table(const SIDBase& sidbase);
         [[nodiscard]] std::unique_ptr<std::byte[]> get_unmapped() const;
 
         
@@ -1,14 +1,45 @@
 #pragma once
 
 #include "ast/type.h"
+#include "compilation/symbol_table.h"
 #include "sidbase.h"
 
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <ranges>
+#include <span>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace dconstruct::compilation {
+    // every binding of every open scope in one vector, scopes are marked by where they start.
+    // each symbol knows its innermost binding, so lookups don't walk the enclosing scopes.
     template<typename T = ast::typed_value>
     struct environment {
-        environment() noexcept : m_enclosing(nullptr) {};
+        static constexpr u32 no_binding = std::numeric_limits<u32>::max();
+
+        struct binding {
+            symbol_id m_name;
+            T m_value;
+            // the binding of the same name this one hides
+            u32 m_shadowed;
+            bool m_live;
+        };
+
+        // opens a scope for as long as it lives
+        struct nested_scope {
+            explicit nested_scope(environment& env) : m_env(env) { m_env.push_scope(); }
+            ~nested_scope() noexcept { m_env.pop_scope(); }
+
+            nested_scope(const nested_scope&) = delete;
+            nested_scope& operator=(const nested_scope&) = delete;
+
+            environment& m_env;
+        };
+
+        environment() noexcept = default;
         
         environment(const environment& rhs) = delete;
 
@@ -17,83 +48,145 @@ namespace dconstruct::compilation {
         environment& operator=(environment&& rhs) = default;
         environment(environment&& rhs) = default;
 
-        explicit environment(environment* enclosing) noexcept : m_enclosing(enclosing) {};
+        std::vector<binding> m_bindings;
+        std::vector<u32> m_scopeStarts{ 0 };
+        // index into m_bindings for every symbol
+        std::vector<u32> m_innermost;
+
+        void push_scope() {
+            m_scopeStarts.push_back(static_cast<u32>(m_bindings.size()));
+        }
 
-        std::unordered_map<std::string, T> m_values;
+        void pop_scope() noexcept {
+            assert(m_scopeStarts.size() > 1 && "popping the outermost scope");
+            const u32 start = m_scopeStarts.back();
+            m_scopeStarts.pop_back();
+            while (m_bindings.size() > start) {
+                const binding& last = m_bindings.back();
+                if (last.m_live) {
+                    m_innermost[last.m_name] = last.m_shadowed;
+                }
+                m_bindings.pop_back();
+            }
+        }
 
-        void define(const std::string& name, T value) {
-            m_values[name] = value;
+        // the live bindings of the innermost scope
+        [[nodiscard]] auto current_scope() noexcept {
+            return std::span{ m_bindings }.subspan(m_scopeStarts.back()) | std::views::filter([](const binding& b) { return b.m_live; });
         }
 
-        bool assign(const std::string& name, T value) {
-            if (m_values.contains(name)) {
-                m_values[name] = std::move(value);
-                return true;
+        void define(const symbol_id name, T value) {
+            if (T* local = find_local(name)) {
+                *local = std::move(value);
+                return;
             }
-            if (m_enclosing != nullptr) {
-                m_enclosing->assign(name, std::move(value));
+            if (name >= m_innermost.size()) {
+                m_innermost.resize(name + 1, no_binding);
+            }
+            m_bindings.push_back(binding{ name, std::move(value), m_innermost[name], true });
+            m_innermost[name] = static_cast<u32>(m_bindings.size() - 1);
+        }
+
+        void define(const std::string& name, T value) {
+            define(symbol_table::intern(name), std::move(value));
+        }
+
+        bool assign(const symbol_id name, T value) {
+            if (T* found = lookup(name)) {
+                *found = std::move(value);
+                return defines(name);
             }
             return false;
         }
 
+        bool assign(const std::string& name, T value) {
+            return assign(symbol_table::intern(name), std::move(value));
+        }
+
+        // whether the innermost scope binds the name itself
+        [[nodiscard]] bool defines(const symbol_id name) const noexcept {
+            return find_local(name) != nullptr;
+        }
+
+        [[nodiscard]] const T* lookup(const symbol_id name) const noexcept {
+            const u32 idx = innermost(name);
+            return idx == no_binding ? nullptr : &m_bindings[idx].m_value;
+        }
+
+        [[nodiscard]] T* lookup(const symbol_id name) noexcept {
+            const u32 idx = innermost(name);
+            return idx == no_binding ? nullptr : &m_bindings[idx].m_value;
+        }
+
         [[nodiscard]] const T* lookup(const std::string& name) const {
-            if (auto it = m_values.find(name); it != m_values.end()) {
-                return &it->second;
-            }
-            if (m_enclosing != nullptr) {
-                return m_enclosing->lookup(name);
-            }
-            return nullptr;
+            return lookup(symbol_table::intern(name));
         }
 
         [[nodiscard]] T* lookup(const std::string& name) {
-            if (auto it = m_values.find(name); it != m_values.end()) {
-                return &it->second;
-            }
-            if (m_enclosing != nullptr) {
-                return m_enclosing->lookup(name);
-            }
-            return nullptr;
+            return lookup(symbol_table::intern(name));
         }
 
-        [[nodiscard]] void undefine(const std::string& name) {
+        // unbinds the innermost binding of the name, the binding it shadowed becomes visible again
+        void undefine(const symbol_id name) noexcept {
             assert(lookup(name) != nullptr && "should never be able to remove a non existing variable");
-            if (auto it = m_values.find(name); it != m_values.end()) {
-                m_values.erase(name);
-                return;
-            }
-            if (m_enclosing != nullptr) {
-                m_enclosing->undefine(name);
-            }
+            binding& removed = m_bindings[m_innermost[name]];
+            removed.m_live = false;
+            m_innermost[name] = removed.m_shadowed;
         }
 
-        [[nodiscard]] bool value_used(const T& value) {
-            for (const auto& [key, stored_value] : m_values) {
-                if (value == stored_value) {
-                    return true;
-                }
-            }
-            if (m_enclosing != nullptr) {
-                return m_enclosing->value_used(value);
-            }
-            return false;
+        [[nodiscard]] bool value_used(const T& value) const {
+            return std::any_of(m_bindings.begin(), m_bindings.end(), [&value](const binding& b) {
+                return b.m_live && b.m_value == value;
+            });
+        }
+
+    private:
+        [[nodiscard]] u32 innermost(const symbol_id name) const noexcept {
+            return name < m_innermost.size() ? m_innermost[name] : no_binding;
         }
 
-        environment* m_enclosing;
+        [[nodiscard]] T* find_local(const symbol_id name) noexcept {
+            const u32 idx = innermost(name);
+            return idx != no_binding && idx >= m_scopeStarts.back() ? &m_bindings[idx].m_value : nullptr;
+        }
+
+        [[nodiscard]] const T* find_local(const symbol_id name) const noexcept {
+            const u32 idx = innermost(name);
+            return idx != no_binding && idx >= m_scopeStarts.back() ? &m_bindings[idx].m_value : nullptr;
+        }
     };
 
     struct scope : public environment<ast::full_type> {
 
-        explicit scope(std::unordered_map<std::string, ast::full_type> names_to_types) noexcept : 
-            m_namesToTypes(std::move(names_to_types)){};
+        // opens a scope for variables, type names and sid aliases. the names and aliases of the enclosing scopes
+        // are hidden until it closes, like separate scope objects used to. the expected return type and whether
+        // a return was seen belong to the whole function, so nested scopes share them.
+        struct nested_scope {
+            explicit nested_scope(scope& env) :
+                m_env(env),
+                m_namesToTypes(std::exchange(env.m_namesToTypes, {})),
+                m_sidAliases(std::exchange(env.m_sidAliases, {})) {
+                m_env.push_scope();
+            }
 
-        explicit scope(scope* enclosing) noexcept {
-            m_enclosing = enclosing;
-        }
+            ~nested_scope() noexcept {
+                m_env.pop_scope();
+                m_env.m_namesToTypes = std::move(m_namesToTypes);
+                m_env.m_sidAliases = std::move(m_sidAliases);
+            }
+
+            nested_scope(const nested_scope&) = delete;
+            nested_scope& operator=(const nested_scope&) = delete;
 
-        scope() noexcept {
-            m_enclosing = nullptr;
+            scope& m_env;
+            std::unordered_map<std::string, ast::full_type> m_namesToTypes;
+            std::unordered_map<std::string, sid64_literal> m_sidAliases;
         };
+
+        explicit scope(std::unordered_map<std::string, ast::full_type> names_to_types) noexcept : 
+            m_namesToTypes(std::move(names_to_types)){};
+
+        scope() noexcept = default;
         
         scope(const scope& rhs) = delete;
 
@@ -106,8 +199,8 @@ namespace dconstruct::compilation {
 
         std::unordered_map<std::string, ast::full_type> m_namesToTypes;
         std::unordered_map<std::string, sid64_literal> m_sidAliases;
-        const ast::full_type* m_expectedReturnType;
-        bool m_computedReturnType;
+        const ast::full_type* m_expectedReturnType = nullptr;
+        bool m_computedReturnType = false;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "base.h"
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace dconstruct::compilation {
+
+    using symbol_id = u32;
+
+    // process wide table of identifier names, shared by the decompiler and the compiler.
+    // a name is hashed once when it's interned, everything after that compares and looks up by id.
+    class symbol_table {
+    public:
+        static constexpr symbol_id invalid_symbol = std::numeric_limits<symbol_id>::max();
+
+        [[nodiscard]] static symbol_id intern(const std::string_view name) {
+            symbol_table& table = get();
+            {
+                std::shared_lock lock{ table.m_mutex };
+                if (const auto it = table.m_ids.find(name); it != table.m_ids.end()) {
+                    return it->second;
+                }
+            }
+            std::unique_lock lock{ table.m_mutex };
+            if (const auto it = table.m_ids.find(name); it != table.m_ids.end()) {
+                return it->second;
+            }
+            const symbol_id id = static_cast<symbol_id>(table.m_names.size());
+            // deque never moves its elements, so the views used as keys stay valid
+            const std::string& stored = table.m_names.emplace_back(name);
+            table.m_ids.emplace(stored, id);
+            return id;
+        }
+
+        [[nodiscard]] static const std::string& name(const symbol_id id) {
+            symbol_table& table = get();
+            std::shared_lock lock{ table.m_mutex };
+            return table.m_names.at(id);
+        }
+
+    private:
+        [[nodiscard]] static symbol_table& get() noexcept {
+            static symbol_table table;
+            return table;
+        }
+
+        std::deque<std::string> m_names;
+        std::unordered_map<std::string_view, symbol_id> m_ids;
+        std::shared_mutex m_mutex;
+    };
+}
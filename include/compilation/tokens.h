@@ -2,6 +2,7 @@
 
 #include "base.h"
 #include "ast/type.h"
+#include "compilation/symbol_table.h"
 #include <variant>
 
 namespace dconstruct::compilation {
@@ -53,7 +54,8 @@ namespace dconstruct::compilation {
             :m_literal(std::move(literal)),
             m_lexeme(std::move(lexeme)),
             m_type(type),
-            m_line(line) {}
+            m_line(line),
+            m_symbol(type == token_type::IDENTIFIER ? symbol_table::intern(m_lexeme) : symbol_table::invalid_symbol) {}
 
         [[nodiscard]] bool operator==(const token &rhs) const;
 
@@ -61,5 +63,7 @@ namespace dconstruct::compilation {
         std::string m_lexeme;
         token_type m_type;
         u32 m_line;
+        // only set for identifiers
+        symbol_id m_symbol;
     };
 }
\ No newline at end of file
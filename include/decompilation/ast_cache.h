@@ -0,0 +1,39 @@
+#pragma once
+
+#include "base.h"
+#include "ast/function_definition.h"
+#include "sidbase.h"
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace dconstruct::dcompiler {
+
+    struct cached_functions {
+        std::vector<ast::function_definition> m_functions;
+        std::string m_scriptMetadata;
+    };
+
+    // decompiled functions of previously seen files, one entry per file in the cache directory.
+    // entries are keyed by the file's contents, the sidbase's contents and the options that change the decompiled code,
+    // so rendering a file again in another language doesn't need to decompile it.
+    class ast_cache {
+    public:
+        static constexpr u32 CACHE_MAGIC = 0x43545341;
+        static constexpr u32 CACHE_VERSION = 1;
+
+        explicit ast_cache(std::filesystem::path dir, const SIDBase& base) noexcept : m_dir(std::move(dir)), m_sidbaseDigest(base.get_digest()) {}
+
+        [[nodiscard]] u64 get_key(const std::byte* bytes, const std::size_t size, const bool optimize, const bool is_64_bit) const noexcept;
+
+        [[nodiscard]] std::expected<cached_functions, std::string> load(const u64 key) const;
+        [[nodiscard]] std::expected<void, std::string> save(const u64 key, const std::vector<ast::function_definition>& functions, const std::string& script_metadata) const;
+
+    private:
+        [[nodiscard]] std::filesystem::path get_entry_path(const u64 key) const;
+
+        std::filesystem::path m_dir;
+        u64 m_sidbaseDigest;
+    };
+}
@@ -2,14 +2,15 @@
 
 #include "base.h"
 #include "disassembly/instructions.h"
+#include "decompilation/graph_layout.h"
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
-#include <graphviz/gvc.h>
-#include <graphviz/cgraph.h>
 #include <optional>
 #include <set>
 #include <bitset>
+#include <array>
+#include <span>
 
 namespace dconstruct {
 
@@ -22,8 +23,8 @@ namespace dconstruct {
     struct control_flow_node {
         static constexpr node_id invalid_node = std::numeric_limits<node_id>::max();
 
-        std::vector<function_disassembly_line> m_lines;
-        std::vector<node_id> m_predecessors;
+        std::span<const function_disassembly_line> m_lines;
+        std::span<const node_id> m_predecessors;
         register_nature m_regs;
         node_id m_followingNode = invalid_node;
         node_id m_targetNode = invalid_node;
@@ -32,6 +33,12 @@ namespace dconstruct {
         node_id m_index = 0;
         node_id m_postorder = 0;
         node_id m_ipdom = 0;
+        // preorder/postorder clock of this node in the post-dominator tree
+        node_id m_pdomEnter = invalid_node;
+        node_id m_pdomLeave = invalid_node;
+        // same for the dominator tree, find_loops uses it to keep side entries out of loop bodies
+        node_id m_domEnter = invalid_node;
+        node_id m_domLeave = invalid_node;
 
         explicit control_flow_node() = default;
 
@@ -44,27 +51,90 @@ namespace dconstruct {
         [[nodiscard]] bool operator==(const control_flow_node& rhs) const noexcept;
         [[nodiscard]] bool operator!=(const control_flow_node& rhs) const noexcept;
 
-        [[nodiscard]] std::string get_label_html() const;
         void determine_register_nature();
         [[nodiscard]] register_nature get_register_nature_starting_at(const istr_line start_line, const bool return_is_read) const noexcept;
     };
+    // for every register, the only node that reads it before it's written again, or one of the markers in ControlFlowGraph
+    using reg_readers = std::array<node_id, ARGUMENT_REGISTERS_IDX + 1>;
+
     struct control_flow_loop {
+        static constexpr node_id invalid_loop = std::numeric_limits<node_id>::max();
+
+        // every node of the loop including nested loops, sorted
         std::vector<node_id> m_body;
+        // nodes outside of the loop that the body branches to, sorted
+        std::vector<node_id> m_exits;
+        // indices into m_loops
+        std::vector<node_id> m_children;
         node_id m_headNode;
         node_id m_latchNode;
+        node_id m_parent = invalid_loop;
     };
 
-    
+    enum class region_kind : u8 {
+        block,
+        if_then,
+        if_else,
+        for_loop,
+        while_loop,
+        // a block that falls through into a loop head
+        loop_entry,
+    };
 
-    [[nodiscard]] const control_flow_node& intersect(const node_id node_b1, const node_id node_b2, const std::vector<control_flow_node>& nodes);
+    // the construct a node starts, the enclosing sequence carries on at m_follow
+    struct control_flow_region {
+        region_kind m_kind = region_kind::block;
+        node_id m_follow = control_flow_node::invalid_node;
+    };
+
+    enum class graph_format : u8 {
+        // rendered while decompiling
+        svg,
+        // graphviz source, rendered later with dot
+        dot,
+        // queued while decompiling and rendered once all files are done
+        svg_async,
+    };
+
+    // the text, edges & loops of a graph copied out of the function, so it can still be drawn after the file is gone
+    struct control_flow_image {
+        struct loop {
+            std::vector<node_id> m_body;
+            std::vector<node_id> m_children;
+            // how deep other loops are nested inside this one
+            u32 m_nesting = 0;
+            bool m_isOutermost = true;
+        };
+
+        std::vector<std::vector<std::string>> m_labels;
+        std::vector<layout_edge> m_edges;
+        std::vector<const char*> m_edgeColors;
+        std::vector<loop> m_loops;
+        node_id m_returnNode = 0;
+
+        void write_svg(const std::string& path) const;
+        void write_dot(const std::string& path) const;
+    };
 
     class ControlFlowGraph {
     public:
         std::vector<control_flow_node> m_nodes;
         std::vector<control_flow_loop> m_loops;
+        // index into m_loops for every node that heads a loop
+        std::vector<node_id> m_loopWithHead;
+        // predecessors of all nodes back to back, each node's m_predecessors points into this
+        std::vector<node_id> m_predecessorList;
+        std::vector<reg_set> m_liveIn;
+        // same as m_liveIn, but the return node's reads aren't propagated to its predecessors
+        std::vector<reg_set> m_liveInBeforeReturn;
+        std::vector<reg_readers> m_readers;
+        std::vector<control_flow_region> m_regions;
 
         const function_disassembly &m_func;
 
+        ControlFlowGraph(ControlFlowGraph&&) noexcept = default;
+        ControlFlowGraph(const ControlFlowGraph&) = delete;
+        ControlFlowGraph& operator=(const ControlFlowGraph&) = delete;
         
         [[nodiscard]] static ControlFlowGraph build(const function_disassembly& func) noexcept;
 
@@ -72,32 +142,41 @@ namespace dconstruct {
         void find_loops();
         void write_to_txt_file(const std::string& path = "graph.txt") const;
         void write_image(const std::string &path = "graph.svg") const;
-        
-        void insert_loop_subgraphs(Agraph_t *g) const;
+        void write_dot(const std::string &path = "graph.dot") const;
+        [[nodiscard]] control_flow_image get_image() const;
 
         [[nodiscard]] const control_flow_node& operator[](const node_id at) const;
 
         [[nodiscard]] const control_flow_loop* get_loop_with_head(const node_id node) const;
 
+        [[nodiscard]] bool postdominates(const node_id dominator, const node_id node) const noexcept;
+        [[nodiscard]] bool dominates(const node_id dominator, const node_id node) const noexcept;
+
         [[nodiscard]] reg_set get_registers_written_to(const control_flow_node& node, const node_id stop) const;
         [[nodiscard]] reg_set get_branch_phi_registers(const control_flow_node& start_node) const noexcept;
         [[nodiscard]] reg_set get_loop_phi_registers(const control_flow_node& fist_head_node, const control_flow_node& last_head_node) const noexcept;
 
-        [[nodiscard]] reg_set get_read_registers(const control_flow_node& start_node, reg_set check_regs, const node_id stop_node, istr_line start_line = 0) const noexcept;
+        [[nodiscard]] reg_set get_read_registers(const control_flow_node& start_node, const reg_set check_regs, const bool stop_at_return = false, const istr_line start_line = 0) const noexcept;
         
         u8 get_register_read_count(const control_flow_node& start_node, const reg_idx reg_to_check, const istr_line start_line = 0) const noexcept;
         [[nodiscard]] const control_flow_node& get_final_loop_condition_node(const control_flow_loop& loop, const node_id exit_node) const noexcept;
     
     private:
+        static constexpr node_id no_reader = control_flow_node::invalid_node;
+        static constexpr node_id many_readers = control_flow_node::invalid_node - 1;
+        static constexpr node_id start_node_reader = control_flow_node::invalid_node - 2;
+
+        [[nodiscard]] static node_id join_readers(const node_id a, const node_id b) noexcept;
+
         ControlFlowGraph() = default;
         explicit ControlFlowGraph(const function_disassembly& fn) noexcept : m_func(fn) {};
-        explicit ControlFlowGraph(const function_disassembly& func, std::vector<control_flow_node> nodes) : m_func(func), m_nodes(std::move(nodes)) {};
+        explicit ControlFlowGraph(const function_disassembly& func, std::vector<control_flow_node> nodes, std::vector<node_id> predecessors) : 
+        m_nodes(std::move(nodes)), m_predecessorList(std::move(predecessors)), m_func(func) {};
         void compute_postdominators();
-
-        [[nodiscard]] std::vector<Agnode_t*> insert_graphviz_nodes(Agraph_t* g) const;
-        void insert_graphviz_edges(Agraph_t* g, const std::vector<Agnode_t*>& nodes) const;
-
-        [[nodiscard]] std::vector<node_id> collect_loop_body(const node_id, const node_id) const;
+        void compute_dominators();
+        void compute_liveness();
+        void find_regions();
+        [[nodiscard]] bool is_for_loop(const control_flow_loop& loop) const noexcept;
     };
 
     
@@ -1,8 +1,11 @@
+#pragma once
+
 #include "base.h"
 #include "ast/type.h"
 #include "ast/ast.h"
 #include "binaryfile.h"
 #include "decompilation/control_flow_graph.h"
+#include "decompilation/graph_queue.h"
 #include "ast/ast_source.h"
 #include <set>
 #include <stack>
@@ -11,25 +14,18 @@ constexpr u8 MAX_EXPRESSION_COMPLEXITY = 4;
 
 namespace dconstruct::dcompiler {
     struct decomp_function {
-        decomp_function(const function_disassembly& func, const BinaryFile& file, ControlFlowGraph graph, std::optional<std::filesystem::path> graph_path = std::nullopt) noexcept : 
+        decomp_function(const function_disassembly& func, const BinaryFile& file, ControlFlowGraph graph, std::optional<std::filesystem::path> graph_path = std::nullopt,
+            const graph_format format = graph_format::svg, graph_queue* queue = nullptr) noexcept : 
         m_disassembly(func), 
         m_file(file), 
         m_graphPath(graph_path), 
-        m_graph(graph), 
-        m_parsedNodes(graph.m_nodes.size(), false), 
+        m_graphFormat(format), 
+        m_graphQueue(queue), 
+        m_graph(std::move(graph)), 
+        m_parsedNodes(m_graph.m_nodes.size(), false), 
         m_ipdomsEmitted(m_graph.m_nodes.size(), false),
         m_functionDefinition{} {};
 
-        // struct allocator {
-
-        // };
-
-
-        // template<node_t, Args... args> requires (std::is_base_of<node_t, ast::ast_element>)
-        // [[nodiscard]] expr_uptr create_node(Args ...args)  {
-        //     return new (m_arena) node_t(std::forward(args)...);
-        // }
-
         const ast::function_definition& decompile(const bool optimization_passes = false) & ;
         [[nodiscard]] ast::function_definition decompile(const bool optimization_passes = false) && ;
 
@@ -47,6 +43,9 @@ namespace dconstruct::dcompiler {
         const function_disassembly& m_disassembly;
         const BinaryFile& m_file;
         std::optional<std::filesystem::path> m_graphPath;
+        graph_format m_graphFormat;
+        // svg_async graphs are pushed here instead of being rendered
+        graph_queue* m_graphQueue;
         ast::function_definition m_functionDefinition;
         node_set m_parsedNodes;
         node_set m_ipdomsEmitted;
@@ -54,20 +53,18 @@ namespace dconstruct::dcompiler {
 		u16 m_varCount = 0;
         bool m_is64Bit = true;
 
-        void emit_node(const control_flow_node &node, const node_id stop_node);
+        void emit_sequence(node_id start, const node_id stop_node);
 
-        void emit_if_else(const control_flow_node &node, const node_id stop_node);
+        [[nodiscard]] node_id emit_node(const control_flow_node &node, const node_id stop_node);
 
-        void emit_if(const control_flow_node& node, const node_id stop_node);
+        void emit_if_else(const control_flow_node &node);
+
+        void emit_if(const control_flow_node& node);
  
         void emit_branch(ast::block& block, node_id proper_destination, const node_id idom, reg_set regs_to_emit, std::unordered_map<reg_idx, dconstruct::ast::full_type> &regs_to_type);
 
-        void emit_loop(const control_flow_loop &loop, const node_id stop_node);
-
-        [[nodiscard]] bool is_for_loop(const control_flow_loop& loop) const noexcept;
-
-        void emit_for_loop(const control_flow_loop &loop, const node_id stop_node);
-        void emit_while_loop(const control_flow_loop &loop, const node_id stop_node);
+        void emit_for_loop(const control_flow_loop &loop);
+        void emit_while_loop(const control_flow_loop &loop);
 
         void parse_basic_block(const control_flow_node& node);
 
@@ -104,27 +101,32 @@ namespace dconstruct::dcompiler {
 
         void set_binary_types(expr_uptr& lhs, expr_uptr& rhs) const noexcept;
 
+        // the grouped operand in reg, moved out of its slot if the instruction overwrites it anyway
+        [[nodiscard]] inline expr_uptr take_grouped(const reg_idx reg, const bool overwritten) {
+            auto& expr = m_transformableExpressions[reg];
+            if (!overwritten) {
+                return expr->get_grouped();
+            }
+            if (expr->needs_grouping()) {
+                return std::make_unique<ast::grouping>(std::move(expr));
+            }
+            return std::move(expr);
+        }
+
         template <typename T>
         [[nodiscard]] inline std::unique_ptr<T> apply_binary_op(const Instruction& istr) {
-            auto& op1 = m_transformableExpressions[istr.operand1];
-            auto& op2 = m_transformableExpressions[istr.operand2];
-            set_binary_types(op1, op2);
-            return std::make_unique<T>(
-                op1->get_grouped(),
-                op2->get_grouped()
-            );
+            set_binary_types(m_transformableExpressions[istr.operand1], m_transformableExpressions[istr.operand2]);
+            auto lhs = take_grouped(istr.operand1, istr.destination == istr.operand1 && istr.operand1 != istr.operand2);
+            auto rhs = take_grouped(istr.operand2, istr.destination == istr.operand2);
+            return std::make_unique<T>(std::move(lhs), std::move(rhs));
         }
 
         template <typename T>
         [[nodiscard]] inline std::unique_ptr<T> apply_binary_op(const Instruction& istr, compilation::token op) {
-            auto& op1 = m_transformableExpressions[istr.operand1];
-            auto& op2 = m_transformableExpressions[istr.operand2];
-            set_binary_types(op1, op2);
-            auto expr = std::make_unique<T>(
-                std::move(op),
-                op1->get_grouped(),
-                op2->get_grouped()
-            );
+            set_binary_types(m_transformableExpressions[istr.operand1], m_transformableExpressions[istr.operand2]);
+            auto lhs = take_grouped(istr.operand1, istr.destination == istr.operand1 && istr.operand1 != istr.operand2);
+            auto rhs = take_grouped(istr.operand2, istr.destination == istr.operand2);
+            auto expr = std::make_unique<T>(std::move(op), std::move(lhs), std::move(rhs));
             if constexpr (std::is_same_v<T, ast::compare_expr>) {
                 const bool is_comp = expr->m_operator.m_lexeme == "==" || expr->m_operator.m_lexeme == "!=";
                 if (is_comp && expr->m_lhs->as_literal()) {
@@ -136,17 +138,15 @@ namespace dconstruct::dcompiler {
 
         template <typename T>
         [[nodiscard]] inline std::unique_ptr<T> apply_binary_op_imm(const Instruction& istr) {
-            const auto& op1 = m_transformableExpressions[istr.operand1];
             return std::make_unique<T>(
-                op1->get_grouped(),
+                take_grouped(istr.operand1, istr.destination == istr.operand1),
                 std::make_unique<ast::literal>(istr.operand2)
             );
         }
 
         template <typename T>
         [[nodiscard]] inline std::unique_ptr<T> apply_unary_op(const Instruction& istr) {
-            const auto& op1 = m_transformableExpressions[istr.operand1];
-            return std::make_unique<T>(op1->get_grouped());
+            return std::make_unique<T>(take_grouped(istr.operand1, istr.destination == istr.operand1));
         }
 
         [[nodiscard]] std::unique_ptr<ast::call_expr> make_shift(const Instruction& istr);
@@ -171,8 +171,14 @@ namespace dconstruct::dcompiler {
 
         const BinaryFile* m_binFile = nullptr;
 
+        // options & declarations block, rendered once up front since it only depends on the binary file
+        std::string m_scriptMetadata;
+
         state_script_functions(const std::vector<ast::function_definition>& funcs, const BinaryFile* binary_file = nullptr) noexcept;
 
+        // for functions loaded from the ast cache, where the binary file isn't read anymore
+        state_script_functions(const std::vector<ast::function_definition>& funcs, std::string script_metadata) noexcept;
+
         [[nodiscard]] void to_string(std::ostream& os) const noexcept;
 
         void emit_script_metadata(std::ostream &os) const;
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "base.h"
+#include "binaryfile.h"
+#include "ast/function_definition.h"
+#include <atomic>
+#include <expected>
+#include <optional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dconstruct::dcompiler {
+
+    // decompiled functions by content, shared by every file of a batch. the same script lambdas show up in lots of files
+    // and state script tracks, so each distinct one is only structured & optimized once and copied for the others.
+    // nothing is ever evicted, so the ast of every distinct function stays on the heap until the memo is destroyed at the end of the batch.
+    class function_memo {
+    public:
+        // everything the decompiler reads from a function: instructions, labels, argument types and the symbol table
+        // entries the instructions load, resolved so it's the same in every file. the hash only picks the bucket,
+        // a hit needs the whole content to match.
+        struct key {
+            u64 m_hash = 0;
+            std::vector<std::byte> m_content;
+        };
+
+        [[nodiscard]] static key get_key(const function_disassembly& func, const BinaryFile& file, const bool optimize);
+
+        // a copy of the memoized function under the new name, allocated in the current node arena.
+        // holds an error instead if the function couldn't be decompiled the first time.
+        [[nodiscard]] std::optional<std::expected<ast::function_definition, std::string>> find(const key& key, const function_name_variant& name);
+
+        void insert(const key& key, const ast::function_definition& func);
+        void insert_error(const key& key, std::string error);
+
+        void print_stats(std::ostream& os) const;
+
+    private:
+        struct entry {
+            std::vector<std::byte> m_content;
+            ast::function_definition m_function;
+            std::string m_error;
+        };
+
+        // inserts the entry unless another thread already added the same content
+        void insert_entry(const u64 hash, entry&& new_entry);
+
+        mutable std::shared_mutex m_mutex;
+        // the entries' nodes are allocated outside of any arena, so they outlive the files they came from
+        std::unordered_multimap<u64, entry> m_entries;
+        std::atomic<u64> m_lookups = 0;
+        std::atomic<u64> m_hits = 0;
+    };
+}
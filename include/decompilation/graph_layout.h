@@ -0,0 +1,33 @@
+#pragma once
+
+#include "base.h"
+#include <span>
+#include <vector>
+
+namespace dconstruct {
+
+    struct layout_point {
+        f32 m_x = 0.f;
+        f32 m_y = 0.f;
+    };
+
+    struct layout_edge {
+        node_id m_from;
+        node_id m_to;
+    };
+
+    struct graph_layout {
+        // top left corner of every node
+        std::vector<layout_point> m_nodes;
+        // polyline of every edge, from the source node's border to the target node's border
+        std::vector<std::vector<layout_point>> m_edges;
+        f32 m_width = 0.f;
+        f32 m_height = 0.f;
+    };
+
+    // layered drawing of a graph whose nodes are in program order, like dot does it: nodes are put into layers by their longest path
+    // from the start, long edges get dummy nodes in every layer they cross, the layers are reordered to untangle the edges and the nodes
+    // are shifted towards their neighbours. edges going up are drawn along the right side of the nodes.
+    // only works on the arguments, so any number of graphs can be laid out at the same time.
+    [[nodiscard]] graph_layout layout_layered(std::span<const layout_point> node_sizes, std::span<const layout_edge> edges, const node_id last_node);
+}
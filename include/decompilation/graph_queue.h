@@ -0,0 +1,29 @@
+#pragma once
+
+#include "base.h"
+#include "decompilation/control_flow_graph.h"
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+namespace dconstruct {
+
+    // graphs of --graphs=svg-async. decompiling only copies each graph in here, they're laid out
+    // and written once all files are done, so drawing them never holds up the decompiler
+    class graph_queue {
+    public:
+        void push(control_flow_image image, std::filesystem::path path);
+
+        // renders the queued graphs spread over all cores and empties the queue. returns how many were rendered
+        std::size_t render_all();
+
+    private:
+        struct job {
+            control_flow_image m_image;
+            std::filesystem::path m_path;
+        };
+
+        std::mutex m_mutex;
+        std::vector<job> m_jobs;
+    };
+}
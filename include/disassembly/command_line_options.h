@@ -0,0 +1,103 @@
+#pragma once
+
+#include "decompilation/control_flow_graph.h"
+#include "cxxopts.hpp"
+#include "windows.h"
+#include <locale>
+#include <codecvt>
+#include <filesystem>
+#include <optional>
+#include <iostream>
+
+namespace dconstruct::disassembly {
+
+static constexpr char DEFAULT_OUT[] = "<input_path.asm>";
+
+[[nodiscard]] static std::wstring get_executable_path() {
+    wchar_t buffer[MAX_PATH];
+    DWORD len = GetModuleFileNameW(nullptr, buffer, MAX_PATH);
+    if (len == 0 || len == MAX_PATH)
+        throw std::runtime_error("GetModuleFileNameW failed");
+    return std::wstring(buffer, len);
+}
+
+[[nodiscard]] static std::optional<dconstruct::graph_format> get_graph_format(const std::string& input_string) {
+    if (input_string == "svg") {
+        return dconstruct::graph_format::svg;
+    } else if (input_string == "dot") {
+        return dconstruct::graph_format::dot;
+    } else if (input_string == "svg-async") {
+        return dconstruct::graph_format::svg_async;
+    } else {
+        return std::nullopt;
+    }
+}
+
+[[nodiscard]] static std::optional<std::pair<cxxopts::Options, cxxopts::ParseResult>> get_command_line_options(int argc, char* argv[]) {
+    cxxopts::Options options("dconstruct", "\na program for disassembling, editing and decompiling tlouii dc files. use --about for a more detailed description.\n");
+
+    using convert_type = std::codecvt_utf8<wchar_t>;
+    std::wstring_convert<convert_type, wchar_t> converter;
+
+    std::filesystem::path current_program_path = converter.to_bytes(dconstruct::disassembly::get_executable_path());
+
+    options.add_options("information")
+        ("h, help", "display this message")
+        ("help_edit", "help with editing a file")
+        ("a,about", "print about");
+    options.add_options("input/output")
+        ("i,input",  "input DC file or folder", cxxopts::value<std::string>(), "<path>")
+        ("o,output", "output file or folder", cxxopts::value<std::string>()->default_value(""), dconstruct::disassembly::DEFAULT_OUT)
+        ("s,sidbase", "sidbase file", cxxopts::value<std::string>()->default_value((current_program_path.parent_path() / "sidbase.bin").string()), "<path>");
+    options.add_options("configuration")
+        ("no_decompile", "don't emit a file containing the decompiled functions (excluding those nested inside structs).", cxxopts::value<bool>()->default_value("false"))
+        ("no_optimize", "don't optimize/cleanup the decompiled code output, e.g. replacing some 'for' loops with 'foreach' loops, some if-else chains with match expressions, and removing unused variables.", 
+            cxxopts::value<bool>()->default_value("false"))
+        ("verbose", "emit verbose details for script-lambda and state-script structs, including all known fields from DCScript.h.", cxxopts::value<bool>()->default_value("false"))
+        ("pascal_case", "convert the games function names into pascal case in the DCPL output.", cxxopts::value<bool>()->default_value("false"))
+        ("show_warnings", "don't show warnings for functions that couldn't be decompiled.", cxxopts::value<bool>()->default_value("false"))
+        ("language", "specify the DCPL pseudo language type. current options are 'C', 'Racket' (closest to original DC), or 'Python'. default is 'C'. a comma separated list like 'C,Python,Racket' decompiles once and writes one <name>.<lang>.dcpl per language, append '-pascal' to a language for a pascal case variant.", cxxopts::value<std::string>()->default_value("C"))
+        //("shader", "treat the input as a shader file instead.", cxxopts::value<bool>()->default_value("false"))
+        ("graphs", "emit control flow graphs of the named functions when decompiling. 'svg' (the default) renders them while decompiling, 'dot' writes graphviz .dot files instead, "
+            "which is much faster, and 'svg-async' renders the svgs on all cores once every file has been decompiled.", cxxopts::value<std::string>()->implicit_value("svg"), "[svg|dot|svg-async]")
+        ("emit_once", "only emit the first occurence of a struct. repeating instances will still show the address but not the contents of the struct.", 
+            cxxopts::value<bool>()->default_value("false"))
+        ("layout_cache", "path to a struct layout cache, created if it doesn't exist. once a struct type has been inferred with the same member layout a few times, and never with a different one, later runs decode it with that layout directly. layouts found during a run are only used from the next run on, so the output doesn't depend on the order the files are processed in.", 
+            cxxopts::value<std::string>(), "<path>")
+        ("validate_layouts", "flag struct instances that contradict their cached layout. requires --layout_cache.", cxxopts::value<bool>()->default_value("false"))
+        ("ast_cache", "folder to keep the decompiled functions of each input file in. a file that was decompiled before with the same sidbase and optimization setting is only disassembled "
+            "and printed again, without decompiling it, so switching the language is fast. not used together with --graphs or edits.",
+            cxxopts::value<std::string>(), "<path>")
+        ("uc4", "experimental: try to disassemble/decompile an uncharted 4 .bin file instead. not tested, so might be very broken.", cxxopts::value<bool>()->default_value("false"));
+
+    options.add_options("edit")
+        ("e,edit", "make an edit at a specific address. may only be specified during single file disassembly.", cxxopts::value<std::vector<std::string>>(), "<addr>[<offset>]=<new_value>")
+        ("edit_file", "specify a path to an edit file. a line in an edit file is equivalent to the value for one -e flag.", cxxopts::value<std::string>())
+    ;
+
+    // --graphs has an implicit value, so cxxopts only reads '--graphs=dot' as the format and would take the 'dot' of '--graphs dot' as the input path
+    std::vector<std::string> args(argv, argv + argc);
+    for (auto it = args.begin(); it != args.end(); ++it) {
+        if (*it == "--graphs" && it + 1 != args.end() && get_graph_format(*(it + 1))) {
+            *it += "=" + *(it + 1);
+            it = args.erase(it + 1) - 1;
+        }
+    }
+    std::vector<char*> joined_argv;
+    for (auto& arg : args) {
+        joined_argv.push_back(arg.data());
+    }
+
+    options.parse_positional({"i"});
+    cxxopts::ParseResult opts;
+    try {
+        opts = options.parse(static_cast<int>(joined_argv.size()), joined_argv.data());
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return std::nullopt;
+    }
+
+    return std::pair{options, opts};
+}
+
+}
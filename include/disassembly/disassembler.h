@@ -4,6 +4,8 @@
 #include "binaryfile.h"
 #include "instructions.h"
 #include "custom_structs.h"
+#include "struct_layout_cache.h"
+#include "struct_kinds.h"
 #include <vector>
 #include <unordered_map>
 
@@ -32,6 +34,10 @@ namespace dconstruct {
         u8 m_indentPerLevel = 2;
         bool m_emitOnce = false;
         bool m_verbose = false;
+        StructLayoutCache* m_layoutCache = nullptr;
+        bool m_validateLayouts = false;
+        // threads a single file may use for itself, files of a batch already get one thread each
+        u32 m_numThreads = 1;
     };
 
     
@@ -74,6 +80,16 @@ namespace dconstruct {
 
         void insert_entry(const Entry* entry);
         void insert_struct(const structs::unmapped* entry, const u32 indent = 0, const sid64 name_id = 0);
+
+        // renders the members of a struct, returns false if it already closed the struct itself
+        using struct_renderer = bool (Disassembler::*)(const structs::unmapped*, const u32, const sid64);
+        static const std::array<struct_renderer, static_cast<u64>(struct_kind::COUNT)> STRUCT_RENDERERS;
+        bool insert_state_script_body(const structs::unmapped*, const u32, const sid64);
+        bool insert_script_lambda_body(const structs::unmapped*, const u32, const sid64);
+        bool insert_map_body(const structs::unmapped*, const u32, const sid64);
+        bool insert_point_curve_body(const structs::unmapped*, const u32, const sid64);
+        bool insert_symbol_array_body(const structs::unmapped*, const u32, const sid64);
+        bool insert_unmapped_struct_body(const structs::unmapped*, const u32, const sid64);
         template<TextFormat text_format = TextFormat{}, typename... Args> 
         void insert_span_fmt(const char* format, Args ...args);
         template<TextFormat text_format = TextFormat{}, typename... Args> 
@@ -101,7 +117,10 @@ namespace dconstruct {
         void insert_ss_lambda_verbose_fields(const SsLambda*, const u32);
         void insert_script_lambda_verbose_fields(const ScriptLambda*, const u32);
         void insert_unmapped_struct(const structs::unmapped*, const u32);
+        [[nodiscard]] bool insert_struct_from_layout(const structs::unmapped*, const struct_table_entry&, const std::vector<member_kind>&, const u32);
         u8 insert_next_struct_member(const location, const u32);
+        [[nodiscard]] member_kind get_member_kind(const location, const char** sid_name = nullptr) const noexcept;
+        u8 insert_struct_member(const location, const member_kind, const u32, const char* sid_name = nullptr);
         void insert_variable(const SsDeclaration* var, const u32);
         void insert_on_block(const SsOnBlock* block, const u32, state_script_function_id& state_name);
         void set_register_types(Register&, Register&, const ast::full_type type);
@@ -116,6 +135,7 @@ namespace dconstruct {
 
         static constexpr u32 INTERPRETED_BUFFER_SIZE = 512;
         static constexpr u32 DISASSEMBLY_BUFFER_SIZE = 256;
+        static constexpr u32 MIN_DEDUP_SIZE = 32;
     };
 
     const static std::unordered_map<sid64, ast::function_type> builtinFunctions = {
@@ -1,22 +1,38 @@
 #include "disassembly/file_disassembler.h"
 #include "disassembly/edit_disassembler.h"
 #include "decompilation/decomp_function.h"
+#include "decompilation/ast_cache.h"
+#include "decompilation/function_memo.h"
+#include "decompilation/graph_queue.h"
 #include "shaders/ndshader.h"
+#include "disassembly/command_line_options.h"
 #include "cxxopts.hpp"
 #include "about.h"
-#include "windows.h"
-#include <locale>
-#include <codecvt>
 #include <chrono>
 #include <iostream>
 #include <filesystem>
 #include <execution>
+#include <ranges>
+#include <string_view>
+#include <thread>
 
 namespace dconstruct::disassembly {
 
-static constexpr char DEFAULT_OUT[] = "<input_path.asm>";
+// one rendering of the decompiled functions, a file is decompiled once and written once per output
+struct dcpl_output {
+    dconstruct::ast::print_options m_options;
+    // put in front of .dcpl when more than one output is written, so they don't overwrite each other
+    std::string m_suffix;
+};
 
-[[nodiscard]] static std::filesystem::path get_sanitized_graph_path(const std::filesystem::path& graph_dir, const std::string &func_id) {
+[[nodiscard]] static std::filesystem::path get_dcpl_output_path(const std::filesystem::path& decomp_path, const dcpl_output& output, const std::size_t output_count) {
+    if (output_count == 1) {
+        return decomp_path;
+    }
+    return std::filesystem::path(decomp_path).replace_extension("").concat(output.m_suffix).concat(".dcpl");
+}
+
+[[nodiscard]] static std::filesystem::path get_sanitized_graph_path(const std::filesystem::path& graph_dir, const std::string &func_id, const dconstruct::graph_format format) {
     std::string sanitized_func_id;
     sanitized_func_id.reserve(func_id.size());
     for (char c : func_id) {
@@ -40,9 +56,23 @@ static constexpr char DEFAULT_OUT[] = "<input_path.asm>";
             }
         }
     }
-    return (graph_dir / sanitized_func_id).replace_extension(".svg");
+    return (graph_dir / sanitized_func_id).replace_extension(format == dconstruct::graph_format::dot ? ".dot" : ".svg");
 } 
 
+static void write_dcpl_outputs(
+    const dconstruct::dcompiler::state_script_functions& output_functions,
+    const std::filesystem::path& out_decomp_filename,
+    const std::vector<dcpl_output>& outputs) {
+    // printing fills the nodes' lazy caches, so the outputs are rendered one after another. batches already run one file per thread.
+    dconstruct::ast::code_writer out;
+    for (const auto& output : outputs) {
+        out.apply(output.m_options);
+        output_functions.to_string(out);
+        std::ofstream file_out(get_dcpl_output_path(out_decomp_filename, output, outputs.size()));
+        out.flush_to(file_out);
+    }
+}
+
 
 static void decomp_file(
     const std::filesystem::path &inpath, 
@@ -50,13 +80,15 @@ static void decomp_file(
     const std::filesystem::path &out_decomp_filename,
     const dconstruct::SIDBase &base,
     const dconstruct::DisassemblerOptions &options,
-    const bool write_graphs,
-    const dconstruct::ast::print_fn_type language_type,
+    const std::optional<dconstruct::graph_format> graphs,
+    const std::vector<dcpl_output> &outputs,
     const bool show_warnings,
     const bool optimize,
     const std::vector<std::string> &edits = {}, 
-    const bool use_pascal_case = false,
-    const bool is_64_bit = true) {
+    const bool is_64_bit = true,
+    const dconstruct::dcompiler::ast_cache* cache = nullptr,
+    dconstruct::dcompiler::function_memo* memo = nullptr,
+    dconstruct::graph_queue* graph_queue = nullptr) {
     
     auto file_res = dconstruct::BinaryFile::from_path(inpath.string());
 
@@ -68,6 +100,15 @@ static void decomp_file(
 
     auto& file = *file_res;
 
+    // the asts of one file are printed together, so they share an arena that's reused for the next file on this thread
+    thread_local dconstruct::ast::node_arena arena;
+    arena.reset();
+    const dconstruct::ast::node_arena::scope arena_scope{arena};
+
+    // graphs are drawn while decompiling and edits are applied after the file is read, so those always decompile
+    const bool use_cache = cache != nullptr && !graphs && edits.empty();
+    const u64 cache_key = use_cache ? cache->get_key(file.m_bytes.get(), file.m_size, optimize, is_64_bit) : 0;
+
     if (is_64_bit) {
         if (!edits.empty()) {
             dconstruct::EditDisassembler ed(&file, &base, options, edits);
@@ -85,35 +126,69 @@ static void decomp_file(
 
     disassembler.dump();
 
+    // a cache hit only skips decompiling, the .asm above is written either way
+    if (use_cache) {
+        auto cached = cache->load(cache_key);
+        if (cached) {
+            const dconstruct::dcompiler::state_script_functions output_functions{cached->m_functions, std::move(cached->m_scriptMetadata)};
+            write_dcpl_outputs(output_functions, out_decomp_filename, outputs);
+            return;
+        }
+    }
+
     const auto funcs = disassembler.get_all_functions();
     if (!funcs.empty()) {
-        std::ofstream out(out_decomp_filename);
         std::vector<dconstruct::ast::function_definition> functions;
         functions.reserve(funcs.size());
-        out << language_type;
-        if (use_pascal_case) {
-            out << dconstruct::ast::func_pascal_case;
-        }
         std::set<u64> emitted_funcs;
+        // every function gets its own graph, so those are always decompiled
+        const bool use_memo = memo != nullptr && !graphs;
 
         for (const auto& func : funcs) {
             std::optional<std::filesystem::path> graph_path = std::nullopt;
-            if (write_graphs) {
+            if (graphs) {
                 auto graph_dir = (std::filesystem::path(out_decomp_filename).replace_extension("").concat("_graphs"));
                 std::filesystem::create_directories(graph_dir);
-                graph_path = get_sanitized_graph_path(graph_dir, func->get_id());
+                graph_path = get_sanitized_graph_path(graph_dir, func->get_id(), *graphs);
+            }
+            dconstruct::dcompiler::function_memo::key memo_key;
+            if (use_memo) {
+                memo_key = dconstruct::dcompiler::function_memo::get_key(*func, file, optimize);
+                auto memoized = memo->find(memo_key, func->m_id);
+                if (memoized) {
+                    if (*memoized) {
+                        functions.push_back(std::move(**memoized));
+                    } else if (show_warnings) {
+                        std::cout << "warning: couldn't decompile <" << func->get_id() << ">: " << memoized->error() << "\n";
+                    }
+                    continue;
+                }
             }
             try {
-                functions.emplace_back(dconstruct::dcompiler::decomp_function{ *func, file, dconstruct::ControlFlowGraph::build(*func), std::move(graph_path) }.decompile(optimize));
+                functions.emplace_back(dconstruct::dcompiler::decomp_function{
+                    *func, file, dconstruct::ControlFlowGraph::build(*func), std::move(graph_path), graphs.value_or(dconstruct::graph_format::svg), graph_queue }.decompile(optimize));
+                if (use_memo) {
+                    memo->insert(memo_key, functions.back());
+                }
             }
             catch (const std::exception& e) {
+                if (use_memo) {
+                    memo->insert_error(memo_key, e.what());
+                }
                 if (show_warnings) {
                     std::cout << "warning: couldn't decompile <" << func->get_id() << ">: " << e.what() << "\n";
                 }
             }
         }
         dconstruct::dcompiler::state_script_functions output_functions{functions, &file};
-        output_functions.to_string(out);
+        write_dcpl_outputs(output_functions, out_decomp_filename, outputs);
+        // saved after printing, so the types filled in while printing are part of the entry
+        if (use_cache) {
+            const auto save_res = cache->save(cache_key, functions, output_functions.m_scriptMetadata);
+            if (!save_res && show_warnings) {
+                std::cout << "warning: " << save_res.error();
+            }
+        }
     }
 }
 
@@ -144,17 +219,28 @@ static void disasm_file(
     disassembler.dump();
 }
 
+// the graphs of --graphs=svg-async, rendered once decompiling is done
+static void render_queued_graphs(dconstruct::graph_queue& graph_queue) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    const std::size_t rendered = graph_queue.render_all();
+    if (rendered == 0) {
+        return;
+    }
+    const auto time_taken = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+    std::cout << "rendered " << rendered << " graphs in " << time_taken.count() << "ms\n";
+}
+
 template <bool is_64_bit = true>
 static void decompile_multiple(
     const std::filesystem::path &in, 
     const std::filesystem::path &out, 
     const dconstruct::SIDBase &sidbase, 
     const dconstruct::DisassemblerOptions &options,
-    const bool generate_graphs,
+    const std::optional<dconstruct::graph_format> graphs,
     const bool show_warnings,
     const bool optimize,
-    const dconstruct::ast::print_fn_type language_print,
-    const bool pascal_case
+    const std::vector<dcpl_output>& outputs,
+    const dconstruct::dcompiler::ast_cache* cache = nullptr
 ) {
 
     std::vector<std::filesystem::path> filepaths;
@@ -170,6 +256,9 @@ static void decompile_multiple(
 
     std::cout << "disassembling & decompiling " << filepaths.size() << " files into " << out << "...\n";
 
+    dconstruct::dcompiler::function_memo memo;
+    dconstruct::graph_queue graph_queue;
+
     std::for_each(
         std::execution::par_unseq,
         filepaths.begin(),
@@ -178,7 +267,7 @@ static void decompile_multiple(
             const std::filesystem::path disasm_outpath = (out / std::filesystem::relative(entry, in)).concat(".asm");
             const std::filesystem::path decomp_outpath = (out / std::filesystem::relative(entry, in)).concat(".dcpl");
             std::filesystem::create_directories(disasm_outpath.parent_path());
-            decomp_file(entry.string(), disasm_outpath, decomp_outpath, sidbase, options, generate_graphs, language_print, show_warnings, optimize, {}, pascal_case);
+            decomp_file(entry.string(), disasm_outpath, decomp_outpath, sidbase, options, graphs, outputs, show_warnings, optimize, {}, is_64_bit, cache, &memo, &graph_queue);
         }
     );
 
@@ -186,6 +275,8 @@ static void decompile_multiple(
 
 
     std::cout << "took " << time_taken.count() << "ms\n";
+    memo.print_stats(std::cout);
+    render_queued_graphs(graph_queue);
 }
 
 static void disassemble_multiple(
@@ -256,14 +347,6 @@ static i32 disassemble_shader(const std::filesystem::path& path) {
     return 0;
 }
 
-[[nodiscard]] static std::wstring get_executable_path() {
-    wchar_t buffer[MAX_PATH];
-    DWORD len = GetModuleFileNameW(nullptr, buffer, MAX_PATH);
-    if (len == 0 || len == MAX_PATH)
-        throw std::runtime_error("GetModuleFileNameW failed");
-    return std::wstring(buffer, len);
-}
-
 [[nodiscard]] static std::optional<dconstruct::ast::print_fn_type> get_print_type(const std::string& input_string) {
     if (input_string == "C" || input_string == "c") {
         return dconstruct::ast::c;
@@ -276,51 +359,31 @@ static i32 disassemble_shader(const std::filesystem::path& path) {
     }
 }
 
-[[nodiscard]] static std::optional<std::pair<cxxopts::Options, cxxopts::ParseResult>> get_command_line_options(int argc, char* argv[]) {
-    cxxopts::Options options("dconstruct", "\na program for disassembling, editing and decompiling tlouii dc files. use --about for a more detailed description.\n");
-
-    using convert_type = std::codecvt_utf8<wchar_t>;
-    std::wstring_convert<convert_type, wchar_t> converter;
-
-    std::filesystem::path current_program_path = converter.to_bytes(dconstruct::disassembly::get_executable_path());
-
-    options.add_options("information")
-        ("h, help", "display this message")
-        ("help_edit", "help with editing a file")
-        ("a,about", "print about");
-    options.add_options("input/output")
-        ("i,input",  "input DC file or folder", cxxopts::value<std::string>(), "<path>")
-        ("o,output", "output file or folder", cxxopts::value<std::string>()->default_value(""), dconstruct::disassembly::DEFAULT_OUT)
-        ("s,sidbase", "sidbase file", cxxopts::value<std::string>()->default_value((current_program_path.parent_path() / "sidbase.bin").string()), "<path>");
-    options.add_options("configuration")
-        ("no_decompile", "don't emit a file containing the decompiled functions (excluding those nested inside structs).", cxxopts::value<bool>()->default_value("false"))
-        ("no_optimize", "don't optimize/cleanup the decompiled code output, e.g. replacing some 'for' loops with 'foreach' loops, some if-else chains with match expressions, and removing unused variables.", 
-            cxxopts::value<bool>()->default_value("false"))
-        ("verbose", "emit verbose details for script-lambda and state-script structs, including all known fields from DCScript.h.", cxxopts::value<bool>()->default_value("false"))
-        ("pascal_case", "convert the games function names into pascal case in the DCPL output.", cxxopts::value<bool>()->default_value("false"))
-        ("show_warnings", "don't show warnings for functions that couldn't be decompiled.", cxxopts::value<bool>()->default_value("false"))
-        ("language", "specify the DCPL pseudo language type. current options are 'C', 'Racket' (closest to original DC), or 'Python'. default is 'C'.", cxxopts::value<std::string>()->default_value("C"))
-        //("shader", "treat the input as a shader file instead.", cxxopts::value<bool>()->default_value("false"))
-        ("graphs", "emit control flow graph SVGs of the named functions when decompiling. only emits graphs of size >1. SIGNIFICANTLY slows down decompilation.", cxxopts::value<bool>()->default_value("false"))
-        ("emit_once", "only emit the first occurence of a struct. repeating instances will still show the address but not the contents of the struct.", 
-            cxxopts::value<bool>()->default_value("false"))
-        ("uc4", "experimental: try to disassemble/decompile an uncharted 4 .bin file instead. not tested, so might be very broken.", cxxopts::value<bool>()->default_value("false"));
-
-    options.add_options("edit")
-        ("e,edit", "make an edit at a specific address. may only be specified during single file disassembly.", cxxopts::value<std::vector<std::string>>(), "<addr>[<offset>]=<new_value>")
-        ("edit_file", "specify a path to an edit file. a line in an edit file is equivalent to the value for one -e flag.", cxxopts::value<std::string>())
-    ;
-
-    options.parse_positional({"i"});
-    cxxopts::ParseResult opts;
-    try {
-        opts = options.parse(argc, argv);
-    } catch (const std::exception& e) {
-        std::cerr << e.what() << "\n";
+// a comma separated list of languages, each optionally ending in '-pascal', e.g. "C,Python-pascal,Racket"
+[[nodiscard]] static std::optional<std::vector<dcpl_output>> get_dcpl_outputs(const std::string& input_string, const bool pascal_case) {
+    static constexpr std::string_view pascal_suffix = "-pascal";
+    std::vector<dcpl_output> outputs;
+    for (const auto part : std::views::split(input_string, ',')) {
+        std::string_view name{ part.begin(), part.end() };
+        bool use_pascal_case = pascal_case;
+        if (name.ends_with(pascal_suffix)) {
+            name.remove_suffix(pascal_suffix.size());
+            use_pascal_case = true;
+        }
+        const auto print_type = get_print_type(std::string{ name });
+        if (!print_type) {
+            return std::nullopt;
+        }
+        std::string suffix = *print_type == dconstruct::ast::py ? ".py" : *print_type == dconstruct::ast::racket ? ".rkt" : ".c";
+        if (use_pascal_case) {
+            suffix += ".pascal";
+        }
+        outputs.push_back(dcpl_output{ dconstruct::ast::print_options{ *print_type, use_pascal_case }, std::move(suffix) });
+    }
+    if (outputs.empty()) {
         return std::nullopt;
     }
-
-    return std::pair{options, opts};
+    return outputs;
 }
 
 }
\ No newline at end of file
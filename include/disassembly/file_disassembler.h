@@ -1,3 +1,5 @@
+#pragma once
+
 #include "disassembler.h"
 #include <fstream>
 
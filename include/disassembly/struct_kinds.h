@@ -0,0 +1,84 @@
+#pragma once
+
+#include "base.h"
+#include <array>
+
+namespace dconstruct {
+    enum class struct_kind : u8 {
+        UNMAPPED,
+        STATE_SCRIPT,
+        SCRIPT_LAMBDA,
+        MAP,
+        ARRAY,
+        POINT_CURVE,
+        SYMBOL_ARRAY,
+        COUNT
+    };
+
+    struct struct_kind_entry {
+        sid64 m_typeId = 0;
+        struct_kind m_kind = struct_kind::UNMAPPED;
+        bool m_editable = true;
+    };
+
+    // struct types that get special handling. anything not in here is treated as an unmapped struct.
+    constexpr std::array<struct_kind_entry, 7> STRUCT_KINDS = {{
+        {SID("state-script"), struct_kind::STATE_SCRIPT, false},
+        {SID("script-lambda"), struct_kind::SCRIPT_LAMBDA, false},
+        {SID("map"), struct_kind::MAP, true},
+        {SID("map-32"), struct_kind::MAP, true},
+        {SID("array"), struct_kind::ARRAY, true},
+        {SID("point-curve"), struct_kind::POINT_CURVE, true},
+        {SID("symbol-array"), struct_kind::SYMBOL_ARRAY, true},
+    }};
+
+    constexpr u32 STRUCT_DISPATCH_BITS = 4;
+    constexpr u32 STRUCT_DISPATCH_SIZE = 1 << STRUCT_DISPATCH_BITS;
+    static_assert(STRUCT_KINDS.size() <= STRUCT_DISPATCH_SIZE);
+
+    // searches for a multiplier that maps every registered type ID to its own slot
+    [[nodiscard]] consteval u64 find_struct_dispatch_multiplier() {
+        for (u64 multiplier = 0x9E3779B97F4A7C15ULL;; multiplier += 2) {
+            std::array<bool, STRUCT_DISPATCH_SIZE> used{};
+            bool collision = false;
+            for (const auto& entry : STRUCT_KINDS) {
+                const u64 slot = (entry.m_typeId * multiplier) >> (64 - STRUCT_DISPATCH_BITS);
+                collision |= used[slot];
+                used[slot] = true;
+            }
+            if (!collision) {
+                return multiplier;
+            }
+        }
+    }
+
+    constexpr u64 STRUCT_DISPATCH_MULTIPLIER = find_struct_dispatch_multiplier();
+
+    [[nodiscard]] constexpr u64 get_struct_dispatch_slot(const sid64 type_id) noexcept {
+        return (type_id * STRUCT_DISPATCH_MULTIPLIER) >> (64 - STRUCT_DISPATCH_BITS);
+    }
+
+    constexpr std::array<struct_kind_entry, STRUCT_DISPATCH_SIZE> STRUCT_DISPATCH_TABLE = [] {
+        std::array<struct_kind_entry, STRUCT_DISPATCH_SIZE> table{};
+        for (const auto& entry : STRUCT_KINDS) {
+            table[get_struct_dispatch_slot(entry.m_typeId)] = entry;
+        }
+        return table;
+    }();
+
+    constexpr struct_kind_entry UNMAPPED_STRUCT_KIND{};
+
+    [[nodiscard]] constexpr const struct_kind_entry& get_struct_kind_entry(const sid64 type_id) noexcept {
+        const struct_kind_entry& entry = STRUCT_DISPATCH_TABLE[get_struct_dispatch_slot(type_id)];
+        return entry.m_typeId == type_id ? entry : UNMAPPED_STRUCT_KIND;
+    }
+
+    [[nodiscard]] constexpr struct_kind get_struct_kind(const sid64 type_id) noexcept {
+        return get_struct_kind_entry(type_id).m_kind;
+    }
+
+    static_assert(get_struct_kind(SID("script-lambda")) == struct_kind::SCRIPT_LAMBDA);
+    static_assert(get_struct_kind(SID("map-32")) == struct_kind::MAP);
+    static_assert(get_struct_kind(SID("symbol-array")) == struct_kind::SYMBOL_ARRAY);
+    static_assert(get_struct_kind(SID("symbol")) == struct_kind::UNMAPPED);
+}
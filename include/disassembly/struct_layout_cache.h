@@ -0,0 +1,77 @@
+#pragma once
+
+#include "base.h"
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <filesystem>
+#include <expected>
+#include <atomic>
+#include <string>
+
+namespace dconstruct {
+    enum class member_kind : u8 {
+        POINTER,
+        SID,
+        FLOAT,
+        I32,
+        UNMAPPED_SID,
+        INT
+    };
+
+    [[nodiscard]] constexpr u8 get_member_kind_size(const member_kind kind) noexcept {
+        switch (kind) {
+            case member_kind::POINTER:
+            case member_kind::SID:
+            case member_kind::UNMAPPED_SID: return 8;
+            default: return 4;
+        }
+    }
+
+    [[nodiscard]] constexpr const char* get_member_kind_name(const member_kind kind) noexcept {
+        switch (kind) {
+            case member_kind::POINTER: return "pointer";
+            case member_kind::SID: return "sid";
+            case member_kind::FLOAT: return "float";
+            case member_kind::I32: return "int";
+            case member_kind::UNMAPPED_SID: return "unmapped sid";
+            default: return "large int";
+        }
+    }
+
+    struct struct_layout {
+        std::vector<member_kind> m_members;
+        u32 m_sightings = 0;
+        // another layout was inferred for the same type, so neither of them is ever confirmed
+        bool m_conflicting = false;
+    };
+
+    // member layouts of unmapped structs, keyed by type ID. a layout is confirmed once it has been inferred REQUIRED_SIGHTINGS times
+    // and no other layout was ever inferred for that type, after that it doesn't change anymore. may be shared by multiple disassemblers at once.
+    // only the layouts that were already confirmed when the cache was loaded are used for decoding, the sightings of the current run
+    // only count for the next one. so the output doesn't depend on the order or the threads the files of a batch are disassembled on.
+    class StructLayoutCache {
+    public:
+        static constexpr u32 REQUIRED_SIGHTINGS = 3;
+        static constexpr u32 CACHE_MAGIC = 0x434C4344;
+        static constexpr u32 CACHE_VERSION = 2;
+
+        [[nodiscard]] std::expected<void, std::string> load(const std::filesystem::path& path);
+        [[nodiscard]] std::expected<void, std::string> save(const std::filesystem::path& path) const;
+
+        [[nodiscard]] const std::vector<member_kind>* get_confirmed(const sid64 type_id) const;
+        void add_sighting(const sid64 type_id, const std::vector<member_kind>& members);
+
+        [[nodiscard]] u64 size() const;
+        [[nodiscard]] u64 num_confirmed() const;
+
+        std::atomic<u64> m_cachedInstances = 0;
+        std::atomic<u64> m_contradictions = 0;
+
+    private:
+        mutable std::shared_mutex m_mutex;
+        std::unordered_map<sid64, struct_layout> m_layouts;
+        // confirmed layouts as loaded, never written after load() so it's read without the lock
+        std::unordered_map<sid64, std::vector<member_kind>> m_confirmed;
+    };
+}
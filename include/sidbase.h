@@ -3,6 +3,7 @@
 #include <memory>
 #include <filesystem>
 #include <expected>
+#include <vector>
 
 namespace dconstruct {
     struct SIDBaseEntry {
@@ -22,7 +23,10 @@ namespace dconstruct {
         //[[nodiscard]] static SIDBase from_uc4_binary(const std::filesystem::path& path) noexcept;
         
         [[nodiscard]] const char* search(const sid64 hash) const noexcept;
+        [[nodiscard]] const char* search(const sid32 hash) const noexcept;
         [[nodiscard]] bool sid_exists(const sid64 hash) const noexcept;
+        // hash of the entry count and every sid & name, walks the whole sidbase so callers should keep it
+        [[nodiscard]] u64 get_digest() const noexcept;
         sid64 m_lowestSid;
         sid64 m_highestSid;
 
@@ -31,6 +35,8 @@ namespace dconstruct {
         u64 m_numEntries;
         std::unique_ptr<std::byte[]> m_sidbytes;
         SIDBaseEntry* m_entries;
+        // only filled for sidbases that contain nothing but 32 bit hashes (uc4), same order as m_entries
+        std::vector<sid32> m_sids32;
     };
 }
 
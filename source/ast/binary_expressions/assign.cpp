@@ -107,7 +107,7 @@ VAR_OPTIMIZATION_ACTION assign_expr::var_optimization_pass(var_optimization_env&
     const auto* lhs = dynamic_cast<const identifier*>(m_lhs.get());
     if (lhs) {
         if (dynamic_cast<const identifier*>(m_rhs.get())) {
-            if (env.m_env.lookup(lhs->m_name.m_lexeme)) {
+            if (env.m_env.lookup(lhs->m_name.m_symbol)) {
                 return VAR_OPTIMIZATION_ACTION::NONE;
             }
         } else {
@@ -142,4 +142,10 @@ MATCH_OPTIMIZATION_ACTION assign_expr::match_optimization_pass(match_optimizatio
     return MATCH_OPTIMIZATION_ACTION::NONE;
 }
 
+void assign_expr::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::ASSIGN);
+    writer.write(m_lhs);
+    writer.write(m_rhs);
+}
+
 }
\ No newline at end of file
@@ -131,4 +131,10 @@ FOREACH_OPTIMIZATION_ACTION cast_expr::foreach_optimization_pass(foreach_optimiz
     return FOREACH_OPTIMIZATION_ACTION::NONE;
 }
 
+void cast_expr::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::CAST);
+    writer.write(m_castType);
+    writer.write(m_rhs);
+}
+
 }
\ No newline at end of file
@@ -9,7 +9,7 @@ void var_optimization_env::check_action(expr_uptr* expr) {
     const auto pass_action = expr->get()->var_optimization_pass(*this);
     switch (pass_action) {
         case VAR_OPTIMIZATION_ACTION::VAR_READ: {
-            const std::string& var_name = static_cast<identifier&>(**expr).m_name.m_lexeme;
+            const compilation::symbol_id var_name = static_cast<identifier&>(**expr).m_name.m_symbol;
             if (!m_isLvalueDereference) {
                 m_env.lookup(var_name)->m_reads.push_back(expr);
             } else {
@@ -20,7 +20,7 @@ void var_optimization_env::check_action(expr_uptr* expr) {
         case VAR_OPTIMIZATION_ACTION::VAR_WRITE: {
             auto* assign = static_cast<assign_expr*>(expr->get());
             assert(dynamic_cast<identifier*>(assign->m_lhs.get()));
-            if (auto* var = m_env.lookup(static_cast<identifier&>(*assign->m_lhs).m_name.m_lexeme)) {
+            if (auto* var = m_env.lookup(static_cast<identifier&>(*assign->m_lhs).m_name.m_symbol)) {
                 var->m_assigns.push_back(expr);
             }
             break;
@@ -37,7 +37,7 @@ void var_optimization_env::check_action(stmnt_uptr* stmt) {
         case VAR_OPTIMIZATION_ACTION::VAR_DECLARATION: {
             auto& decl = static_cast<variable_declaration&>(**stmt);
             auto context = variable_folding_context{stmt, {}, {}};
-            m_env.define(decl.m_identifier, std::move(context));
+            m_env.define(decl.m_symbol, std::move(context));
             break;
         }
         default: {
@@ -253,5 +253,11 @@ MATCH_OPTIMIZATION_ACTION call_expr::match_optimization_pass(match_optimization_
     return res;
 }
 
+void call_expr::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::CALL);
+    writer.write(m_token);
+    writer.write(m_callee);
+    writer.write(m_arguments);
+}
 
 }
\ No newline at end of file
@@ -58,4 +58,9 @@ FOREACH_OPTIMIZATION_ACTION grouping::foreach_optimization_pass(foreach_optimiza
     return FOREACH_OPTIMIZATION_ACTION::NONE;
 }
 
+void grouping::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::GROUPING);
+    writer.write(m_expr);
+}
+
 }
\ No newline at end of file
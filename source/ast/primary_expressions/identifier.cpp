@@ -49,7 +49,7 @@ void identifier::pseudo_racket(std::ostream& os) const {
 }
 
 [[nodiscard]] semantic_check_res identifier::compute_type_checked(compilation::scope& scope) const noexcept {
-    const full_type *type = scope.lookup(m_name.m_lexeme);
+    const full_type *type = scope.lookup(m_name.m_symbol);
     if (!type) {
         return std::unexpected{semantic_check_error{"undeclared identifier: " + m_name.m_lexeme, this}};
     }
@@ -57,7 +57,7 @@ void identifier::pseudo_racket(std::ostream& os) const {
 }
 
 [[nodiscard]] lvalue_emission_res identifier::emit_dc_lvalue(compilation::function& fn, compilation::global_state& global) const noexcept {
-    const reg_idx* var_location = fn.m_varsToRegs.lookup(m_name.m_lexeme);
+    const reg_idx* var_location = fn.m_varsToRegs.lookup(m_name.m_symbol);
 
     if (!var_location) {
         return std::unexpected{"variable " + m_name.m_lexeme + "doesn't have a register."};
@@ -83,7 +83,7 @@ void identifier::pseudo_racket(std::ostream& os) const {
         }
         return *true_destination;
     }
-    const reg_idx* var_location = fn.m_varsToRegs.lookup(m_name.m_lexeme);
+    const reg_idx* var_location = fn.m_varsToRegs.lookup(m_name.m_symbol);
 
     if (!var_location) {
         return std::unexpected{"variable " + m_name.m_lexeme + "doesn't have a register."};
@@ -96,7 +96,7 @@ VAR_OPTIMIZATION_ACTION identifier::var_optimization_pass(var_optimization_env&
     if (!m_name.m_lexeme.starts_with("var")) {
         return VAR_OPTIMIZATION_ACTION::NONE;
     }
-    auto* ctx = env.m_env.lookup(m_name.m_lexeme); 
+    auto* ctx = env.m_env.lookup(m_name.m_symbol); 
     if (!ctx) {
         return VAR_OPTIMIZATION_ACTION::NONE;
     }
@@ -127,4 +127,9 @@ FOREACH_OPTIMIZATION_ACTION identifier::foreach_optimization_pass(foreach_optimi
     return FOREACH_OPTIMIZATION_ACTION::NONE;
 }
 
+void identifier::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::IDENTIFIER);
+    writer.write(m_name);
+}
+
 }
\ No newline at end of file
@@ -177,5 +177,9 @@ MATCH_OPTIMIZATION_ACTION literal::match_optimization_pass(match_optimization_en
    }, m_value);
 }
 
+void literal::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::LITERAL);
+    writer.write(m_value);
+}
 
 }
\ No newline at end of file
@@ -331,4 +331,15 @@ FOREACH_OPTIMIZATION_ACTION match_expr::foreach_optimization_pass(foreach_optimi
     return FOREACH_OPTIMIZATION_ACTION::NONE;
 }
 
+void match_expr::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::MATCH);
+    writer.write(m_conditions);
+    writer.write(static_cast<u32>(m_matchPairs.size()));
+    for (const auto& [patterns, result] : m_matchPairs) {
+        writer.write(patterns);
+        writer.write(result);
+    }
+    writer.write(m_default);
+}
+
 }
\ No newline at end of file
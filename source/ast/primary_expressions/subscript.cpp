@@ -158,4 +158,10 @@ FOREACH_OPTIMIZATION_ACTION subscript_expr::foreach_optimization_pass(foreach_op
     return FOREACH_OPTIMIZATION_ACTION::NONE;
 }
 
+void subscript_expr::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::SUBSCRIPT);
+    writer.write(m_lhs);
+    writer.write(m_rhs);
+}
+
 }
\ No newline at end of file
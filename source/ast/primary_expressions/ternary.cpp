@@ -98,4 +98,11 @@ FOREACH_OPTIMIZATION_ACTION ternary_expr::foreach_optimization_pass(foreach_opti
     return FOREACH_OPTIMIZATION_ACTION::NONE;
 }
 
+void ternary_expr::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::TERNARY);
+    writer.write(m_condition);
+    writer.write(m_then);
+    writer.write(m_else);
+}
+
 }
\ No newline at end of file
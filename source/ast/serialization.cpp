@@ -0,0 +1,432 @@
+#include "ast/serialization.h"
+#include "ast/ast.h"
+#include "ast/primary_expressions/ternary.h"
+
+namespace dconstruct::ast {
+
+void ast_writer::write(const std::string& str) {
+    write(static_cast<u32>(str.size()));
+    const std::size_t offset = m_data.size();
+    m_data.resize(offset + str.size());
+    std::memcpy(m_data.data() + offset, str.data(), str.size());
+}
+
+void ast_writer::write(const compilation::token& token) {
+    write(token.m_type);
+    write(token.m_lexeme);
+    write(token.m_literal);
+    write(token.m_line);
+}
+
+void ast_writer::write(const full_type& type) {
+    write(static_cast<u8>(type.index()));
+    std::visit([&](const auto& t) {
+        using T = std::decay_t<decltype(t)>;
+        if constexpr (std::is_same_v<T, primitive_type>) {
+            write(t.m_type);
+        } else if constexpr (std::is_same_v<T, struct_type>) {
+            write(t.m_name);
+            write(static_cast<u32>(t.m_members.size()));
+            for (const auto& [name, member] : t.m_members) {
+                write(name);
+                write(member);
+            }
+        } else if constexpr (std::is_same_v<T, enum_type>) {
+            write(t.m_name);
+            write(t.m_enumerators);
+        } else if constexpr (std::is_same_v<T, ptr_type>) {
+            write(t.m_pointedAt);
+        } else if constexpr (std::is_same_v<T, function_type>) {
+            write(t.m_return);
+            write(static_cast<u32>(t.m_arguments.size()));
+            for (const auto& [name, arg] : t.m_arguments) {
+                write(name);
+                write(arg);
+            }
+            write(t.m_isFarCall);
+        }
+    }, type);
+}
+
+void ast_writer::write(const ref_full_type& type) {
+    write(static_cast<bool>(type));
+    if (type) {
+        write(*type);
+    }
+}
+
+void ast_writer::write(const primitive_value& value) {
+    write(static_cast<u8>(value.index()));
+    std::visit([&](const auto& v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (serializable_scalar<T>) {
+            write(v);
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            write(v);
+        } else if constexpr (std::is_same_v<T, sid64_literal> || std::is_same_v<T, sid32_literal>) {
+            write(v.first);
+            write(v.second);
+        }
+    }, value);
+}
+
+void ast_writer::write(const expression* expr) {
+    if (!expr) {
+        write(NODE_KIND::NONE);
+        return;
+    }
+    expr->serialize(*this);
+    const std::optional<full_type> type = expr->get_type();
+    write(type.has_value());
+    if (type) {
+        write(*type);
+    }
+}
+
+void ast_writer::write(const statement* stmt) {
+    if (!stmt) {
+        write(NODE_KIND::NONE);
+        return;
+    }
+    stmt->serialize(*this);
+}
+
+void ast_writer::write(const function_definition& func) {
+    write(static_cast<u8>(func.m_name.index()));
+    if (const auto* name = std::get_if<std::string>(&func.m_name)) {
+        write(*name);
+    } else {
+        const auto& id = std::get<state_script_function_id>(func.m_name);
+        write(id.m_state.m_name);
+        write(id.m_state.m_idx);
+        write(id.m_track.m_name);
+        write(id.m_track.m_idx);
+        write(id.m_event.m_name);
+        write(id.m_event.m_idx);
+        write(id.m_idx);
+    }
+    write(static_cast<u32>(func.m_parameters.size()));
+    for (const auto& param : func.m_parameters) {
+        write(param.m_type);
+        write(param.m_name);
+    }
+    write(full_type{ func.m_type });
+    write(&func.m_body);
+}
+
+
+[[nodiscard]] std::string ast_reader::read_string() {
+    const u32 size = read_count();
+    if (m_failed) {
+        return {};
+    }
+    std::string res(reinterpret_cast<const char*>(m_data.data() + m_offset), size);
+    m_offset += size;
+    return res;
+}
+
+[[nodiscard]] compilation::token ast_reader::read_token() {
+    const auto type = read<compilation::token_type>();
+    std::string lexeme = read_string();
+    primitive_value literal = read_primitive();
+    const u32 line = read<u32>();
+    return compilation::token{ type, std::move(lexeme), std::move(literal), line };
+}
+
+[[nodiscard]] full_type ast_reader::read_type() {
+    switch (read<u8>()) {
+        case 0: return std::monostate{};
+        case 1: {
+            const auto kind = read<primitive_kind>();
+            if (kind > primitive_kind::NOTHING) {
+                m_failed = true;
+                return std::monostate{};
+            }
+            return primitive_type{ kind };
+        }
+        case 2: {
+            struct_type res;
+            res.m_name = read_string();
+            const u32 count = read_count();
+            for (u32 i = 0; i < count && !m_failed; ++i) {
+                std::string name = read_string();
+                res.m_members.emplace(std::move(name), read_ref_type());
+            }
+            return res;
+        }
+        case 3: {
+            enum_type res;
+            res.m_name = read_string();
+            const u32 count = read_count();
+            for (u32 i = 0; i < count && !m_failed; ++i) {
+                res.m_enumerators.push_back(read_string());
+            }
+            return res;
+        }
+        case 4: {
+            ptr_type res;
+            res.m_pointedAt = read_ref_type();
+            return res;
+        }
+        case 5: {
+            function_type res;
+            res.m_return = read_ref_type();
+            const u32 count = read_count();
+            for (u32 i = 0; i < count && !m_failed; ++i) {
+                std::string name = read_string();
+                res.m_arguments.emplace_back(std::move(name), read_ref_type());
+            }
+            res.m_isFarCall = read<bool>();
+            return res;
+        }
+        default: {
+            m_failed = true;
+            return std::monostate{};
+        }
+    }
+}
+
+[[nodiscard]] ref_full_type ast_reader::read_ref_type() {
+    if (!read<bool>() || m_failed) {
+        return nullptr;
+    }
+    return intern_type(read_type());
+}
+
+[[nodiscard]] primitive_value ast_reader::read_primitive() {
+    switch (static_cast<primitive_kind>(read<u8>())) {
+        case primitive_kind::U8: return read<u8>();
+        case primitive_kind::U16: return read<u16>();
+        case primitive_kind::U32: return read<u32>();
+        case primitive_kind::U64: return read<u64>();
+        case primitive_kind::I8: return read<i8>();
+        case primitive_kind::I16: return read<i16>();
+        case primitive_kind::I32: return read<i32>();
+        case primitive_kind::I64: return read<i64>();
+        case primitive_kind::F32: return read<f32>();
+        case primitive_kind::F64: return read<f64>();
+        case primitive_kind::CHAR: return read<char>();
+        case primitive_kind::BOOL: return read<bool>();
+        case primitive_kind::STRING: return read_string();
+        case primitive_kind::SID: {
+            const sid64 sid = read<sid64>();
+            return sid64_literal{ sid, read_string() };
+        }
+        case primitive_kind::SID32: {
+            const sid32 sid = read<sid32>();
+            return sid32_literal{ sid, read_string() };
+        }
+        case primitive_kind::NULLPTR: return nullptr;
+        case primitive_kind::NOTHING: return std::monostate{};
+        default: {
+            m_failed = true;
+            return std::monostate{};
+        }
+    }
+}
+
+template <typename binary_impl>
+[[nodiscard]] static expr_uptr read_binary(ast_reader& reader) {
+    compilation::token op = reader.read_token();
+    expr_uptr lhs = reader.read_expression();
+    expr_uptr rhs = reader.read_expression();
+    return std::make_unique<binary_impl>(std::move(op), std::move(lhs), std::move(rhs));
+}
+
+template <typename unary_impl>
+[[nodiscard]] static expr_uptr read_unary(ast_reader& reader) {
+    compilation::token op = reader.read_token();
+    expr_uptr rhs = reader.read_expression();
+    return std::make_unique<unary_impl>(std::move(op), std::move(rhs));
+}
+
+[[nodiscard]] static std::vector<expr_uptr> read_expressions(ast_reader& reader) {
+    const u32 count = reader.read_count();
+    std::vector<expr_uptr> res;
+    res.reserve(count);
+    for (u32 i = 0; i < count && !reader.failed(); ++i) {
+        res.push_back(reader.read_expression());
+    }
+    return res;
+}
+
+[[nodiscard]] expr_uptr ast_reader::read_expression() {
+    if (m_failed) {
+        return nullptr;
+    }
+    expr_uptr res;
+    switch (read<NODE_KIND>()) {
+        case NODE_KIND::NONE: return nullptr;
+        case NODE_KIND::ASSIGN: {
+            expr_uptr lhs = read_expression();
+            expr_uptr rhs = read_expression();
+            res = std::make_unique<assign_expr>(std::move(lhs), std::move(rhs));
+            break;
+        }
+        case NODE_KIND::CAST: {
+            const full_type type = read_type();
+            res = std::make_unique<cast_expr>(type, read_expression());
+            break;
+        }
+        case NODE_KIND::CALL: {
+            compilation::token token = read_token();
+            expr_uptr callee = read_expression();
+            res = std::make_unique<call_expr>(std::move(token), std::move(callee), read_expressions(*this));
+            break;
+        }
+        case NODE_KIND::GROUPING: res = std::make_unique<grouping>(read_expression()); break;
+        case NODE_KIND::IDENTIFIER: res = std::make_unique<identifier>(read_token()); break;
+        case NODE_KIND::LITERAL: res = std::make_unique<literal>(read_primitive()); break;
+        case NODE_KIND::MATCH: {
+            std::vector<expr_uptr> conditions = read_expressions(*this);
+            const u32 count = read_count();
+            std::vector<match_expr::matches_t> pairs;
+            pairs.reserve(count);
+            for (u32 i = 0; i < count && !m_failed; ++i) {
+                std::vector<expr_uptr> patterns = read_expressions(*this);
+                pairs.emplace_back(std::move(patterns), read_expression());
+            }
+            expr_uptr _default = read_expression();
+            res = std::make_unique<match_expr>(std::move(conditions), std::move(pairs), std::move(_default));
+            break;
+        }
+        case NODE_KIND::SIZEOF: {
+            sizeof_expr::operand_t operand;
+            if (read<u8>() == 0) {
+                operand = read_type();
+            } else {
+                operand = read_expression();
+            }
+            res = std::make_unique<sizeof_expr>(std::move(operand));
+            break;
+        }
+        case NODE_KIND::SUBSCRIPT: {
+            expr_uptr lhs = read_expression();
+            expr_uptr rhs = read_expression();
+            res = std::make_unique<subscript_expr>(std::move(lhs), std::move(rhs));
+            break;
+        }
+        case NODE_KIND::TERNARY: {
+            expr_uptr condition = read_expression();
+            expr_uptr then = read_expression();
+            expr_uptr _else = read_expression();
+            res = std::make_unique<ternary_expr>(std::move(condition), std::move(then), std::move(_else));
+            break;
+        }
+        case NODE_KIND::ADD: res = read_binary<add_expr>(*this); break;
+        case NODE_KIND::SUB: res = read_binary<sub_expr>(*this); break;
+        case NODE_KIND::MUL: res = read_binary<mul_expr>(*this); break;
+        case NODE_KIND::DIV: res = read_binary<div_expr>(*this); break;
+        case NODE_KIND::MOD: res = read_binary<mod_expr>(*this); break;
+        case NODE_KIND::SHIFT: res = read_binary<shift_expr>(*this); break;
+        case NODE_KIND::COMPARE: res = read_binary<compare_expr>(*this); break;
+        case NODE_KIND::LOGICAL: res = read_binary<logical_expr>(*this); break;
+        case NODE_KIND::BITWISE_AND: res = read_binary<bitwise_and_expr>(*this); break;
+        case NODE_KIND::BITWISE_OR: res = read_binary<bitwise_or_expr>(*this); break;
+        case NODE_KIND::BITWISE_XOR: res = read_binary<bitwise_xor_expr>(*this); break;
+        case NODE_KIND::NEGATE: res = read_unary<negate_expr>(*this); break;
+        case NODE_KIND::BITWISE_NOT: res = read_unary<bitwise_not_expr>(*this); break;
+        case NODE_KIND::DEREFERENCE: res = read_unary<dereference_expr>(*this); break;
+        case NODE_KIND::LOGICAL_NOT: res = read_unary<logical_not_expr>(*this); break;
+        case NODE_KIND::POST_ARITHMETIC: res = read_unary<post_arithmetic_expression>(*this); break;
+        default: {
+            m_failed = true;
+            return nullptr;
+        }
+    }
+    if (read<bool>()) {
+        res->set_type(read_type());
+    }
+    return m_failed ? nullptr : std::move(res);
+}
+
+[[nodiscard]] stmnt_uptr ast_reader::read_statement() {
+    if (m_failed) {
+        return nullptr;
+    }
+    switch (read<NODE_KIND>()) {
+        case NODE_KIND::NONE: return nullptr;
+        case NODE_KIND::BLOCK: {
+            const u32 count = read_count();
+            std::list<stmnt_uptr> statements;
+            for (u32 i = 0; i < count && !m_failed; ++i) {
+                statements.push_back(read_statement());
+            }
+            return std::make_unique<block>(std::move(statements));
+        }
+        case NODE_KIND::EXPRESSION_STMT: return std::make_unique<expression_stmt>(read_expression());
+        case NODE_KIND::FOR: {
+            stmnt_uptr init = read_statement();
+            expr_uptr condition = read_expression();
+            expr_uptr incr = read_expression();
+            stmnt_uptr body = read_statement();
+            return std::make_unique<for_stmt>(std::move(init), std::move(condition), std::move(incr), std::move(body));
+        }
+        case NODE_KIND::FOREACH: {
+            full_type type = read_type();
+            std::string name = read_string();
+            expr_uptr iterable = read_expression();
+            stmnt_uptr body = read_statement();
+            return std::make_unique<foreach_stmt>(parameter{ std::move(type), std::move(name) }, std::move(iterable), std::move(body));
+        }
+        case NODE_KIND::IF: {
+            expr_uptr condition = read_expression();
+            stmnt_uptr then = read_statement();
+            stmnt_uptr _else = read_statement();
+            return std::make_unique<if_stmt>(std::move(condition), std::move(then), std::move(_else));
+        }
+        case NODE_KIND::WHILE: {
+            expr_uptr condition = read_expression();
+            stmnt_uptr body = read_statement();
+            return std::make_unique<while_stmt>(std::move(condition), std::move(body));
+        }
+        case NODE_KIND::RETURN: return std::make_unique<return_stmt>(read_expression());
+        case NODE_KIND::VARIABLE_DECLARATION: {
+            full_type type = read_type();
+            std::string name = read_string();
+            expr_uptr init = read_expression();
+            return std::make_unique<variable_declaration>(std::move(type), std::move(name), std::move(init));
+        }
+        case NODE_KIND::BREAKPOINT: return std::make_unique<breakpoint>();
+        default: {
+            m_failed = true;
+            return nullptr;
+        }
+    }
+}
+
+[[nodiscard]] function_definition ast_reader::read_function() {
+    function_definition func;
+    if (read<u8>() == 0) {
+        func.m_name = read_string();
+    } else {
+        state_script_function_id id;
+        id.m_state.m_name = read_string();
+        id.m_state.m_idx = read<u32>();
+        id.m_track.m_name = read_string();
+        id.m_track.m_idx = read<u32>();
+        id.m_event.m_name = read_string();
+        id.m_event.m_idx = read<u32>();
+        id.m_idx = read<u64>();
+        func.m_name = std::move(id);
+    }
+    const u32 count = read_count();
+    for (u32 i = 0; i < count && !m_failed; ++i) {
+        full_type type = read_type();
+        func.m_parameters.emplace_back(std::move(type), read_string());
+    }
+    full_type type = read_type();
+    if (auto* func_type = std::get_if<function_type>(&type)) {
+        func.m_type = std::move(*func_type);
+    } else {
+        m_failed = true;
+    }
+    const stmnt_uptr body = read_statement();
+    if (auto* body_block = dynamic_cast<block*>(body.get())) {
+        func.m_body.m_statements = std::move(body_block->m_statements);
+    } else {
+        m_failed = true;
+    }
+    return func;
+}
+}
@@ -65,9 +65,9 @@ void state_script::pseudo_racket(std::ostream& os) const {
 [[nodiscard]] std::vector<semantic_check_error> state_script::check_semantics(compilation::scope& scope) const noexcept {
     std::vector<semantic_check_error> errors;
 
-    compilation::scope decl_scope(&scope);
+    const compilation::scope::nested_scope decl_scope{scope};
     for (const auto& decl : m_declarations) {
-        std::vector<semantic_check_error> decl_errors = decl.check_semantics(decl_scope);
+        std::vector<semantic_check_error> decl_errors = decl.check_semantics(scope);
         errors.insert(errors.end(), decl_errors.begin(), decl_errors.end());
 
         if (!std::holds_alternative<primitive_type>(decl.m_type)) {
@@ -101,7 +101,7 @@ void state_script::pseudo_racket(std::ostream& os) const {
             for (const auto& track : block.m_tracks) {
                 for (size_t i = 0; i < track.m_lambdas.size(); ++i) {
                     const auto& lambda = track.m_lambdas[i];
-                    std::vector<semantic_check_error> lambda_errors = lambda.m_body.check_semantics(decl_scope);
+                    std::vector<semantic_check_error> lambda_errors = lambda.m_body.check_semantics(scope);
                     const std::string path = "in state '" + state.m_name + "' block '" + block.m_name + "' track '" + track.m_name + "' lambda " + std::to_string(i);
                     for (auto& err : lambda_errors) {
                         err.m_message = path + ": " + err.m_message;
@@ -72,7 +72,7 @@ void block::pseudo_racket(std::ostream& os) const {
 }
 
 [[nodiscard]] std::vector<semantic_check_error> block::check_semantics(compilation::scope& env) const noexcept {
-    compilation::scope new_scope(&env);
+    const compilation::scope::nested_scope block_scope{env};
     
     std::vector<semantic_check_error> final_errors;
 
@@ -86,14 +86,16 @@ void block::pseudo_racket(std::ostream& os) const {
 }
 
 VAR_OPTIMIZATION_ACTION block::var_optimization_pass(var_optimization_env& env) noexcept {
-    var_optimization_env new_env{&env.m_env};
+    const compilation::environment<variable_folding_context>::nested_scope block_scope{env.m_env};
     for (auto& statement : m_statements) {
         if (statement) {
-            new_env.check_action(&statement);
+            env.check_action(&statement);
         }
     }
-    for (auto& [name, expression] : new_env.m_env.m_values) {
+    for (auto& var : env.m_env.current_scope()) {
+        auto& expression = var.m_value;
         if (expression.m_reads.size() == 0) {
+            env.m_changed = true;
             auto& decl = static_cast<ast::variable_declaration&>(**expression.m_declaration);
 
             if (!decl.m_init) {
@@ -115,6 +117,7 @@ VAR_OPTIMIZATION_ACTION block::var_optimization_pass(var_optimization_env& env)
             if (init) {
                 *expression.m_reads[0] = std::move(init);
                 *expression.m_declaration = nullptr;
+                env.m_changed = true;
             }
         }
     }
@@ -185,6 +188,7 @@ FOREACH_OPTIMIZATION_ACTION block::foreach_optimization_pass(foreach_optimizatio
 
                 *env.m_for.back() = std::move(for_each);
                 env.m_for.pop_back();
+                env.m_changed = true;
             }
         }
     }
@@ -200,7 +204,9 @@ MATCH_OPTIMIZATION_ACTION block::match_optimization_pass(match_optimization_env&
             return MATCH_OPTIMIZATION_ACTION::RESULT_VAR_ASSIGNMENT;
         }
     } else {
+        const bool changed = env.m_changed;
         env = match_optimization_env{};
+        env.m_changed = changed;
         for (auto& statement : m_statements) {
             if (!statement) {
                 continue;
@@ -220,6 +226,7 @@ MATCH_OPTIMIZATION_ACTION block::match_optimization_pass(match_optimization_env&
                 statement = nullptr;
                 assert(dynamic_cast<variable_declaration*>(env.m_resultDeclaration->get()));
                 static_cast<variable_declaration&>(**env.m_resultDeclaration).m_init = std::move(match);
+                env.m_changed = true;
             } else if (action == MATCH_OPTIMIZATION_ACTION::RESULT_VAR_DECLARATION) {
                 env.m_resultDeclaration = &statement;
             }
@@ -234,10 +241,7 @@ MATCH_OPTIMIZATION_ACTION block::match_optimization_pass(match_optimization_env&
 }
 
 [[nodiscard]] emission_err block::emit_dc(compilation::function& fn, compilation::global_state& global) const noexcept {
-    compilation::environment<reg_idx> old_saved = std::move(fn.m_varsToRegs);
-    compilation::environment<reg_idx> new_env(&old_saved);
-    fn.m_varsToRegs = std::move(new_env);
-    
+    const compilation::environment<reg_idx>::nested_scope block_scope{fn.m_varsToRegs};
 
     for (const auto& statement : m_statements) {
         const emission_err err = statement->emit_dc(fn, global);
@@ -246,13 +250,19 @@ MATCH_OPTIMIZATION_ACTION block::match_optimization_pass(match_optimization_env&
         }
     }
 
-    for (const auto& [_, reg] : fn.m_varsToRegs.m_values) {
-        fn.free_lvalue_register(reg);
+    for (const auto& var : fn.m_varsToRegs.current_scope()) {
+        fn.free_lvalue_register(var.m_value);
     }
 
-    fn.m_varsToRegs = std::move(old_saved);
-
     return std::nullopt;
 }
 
+void block::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::BLOCK);
+    writer.write(static_cast<u32>(m_statements.size()));
+    for (const auto& statement : m_statements) {
+        writer.write(statement);
+    }
+}
+
 }
\ No newline at end of file
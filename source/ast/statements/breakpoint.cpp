@@ -37,4 +37,8 @@ VAR_OPTIMIZATION_ACTION breakpoint::var_optimization_pass(var_optimization_env&
     return std::nullopt;
 }
 
+void breakpoint::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::BREAKPOINT);
+}
+
 }
\ No newline at end of file
@@ -66,5 +66,9 @@ MATCH_OPTIMIZATION_ACTION expression_stmt::match_optimization_pass(match_optimiz
     return m_expression->is_dead_code();
 }
 
+void expression_stmt::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::EXPRESSION_STMT);
+    writer.write(m_expression);
+}
 
 }
\ No newline at end of file
@@ -39,14 +39,14 @@ void for_stmt::pseudo_racket(std::ostream& os) const {
 [[nodiscard]] std::vector<semantic_check_error> for_stmt::check_semantics(compilation::scope& scope) const noexcept {
     std::vector<semantic_check_error> errors;
 
-    compilation::scope nested{&scope};
+    const compilation::scope::nested_scope for_scope{scope};
     
-    std::vector<semantic_check_error> init_errors = m_init->check_semantics(nested);
+    std::vector<semantic_check_error> init_errors = m_init->check_semantics(scope);
     if (!init_errors.empty()) {
         errors = std::move(init_errors);
     }
 
-    semantic_check_res cond_type = m_condition->get_type_checked(nested);
+    semantic_check_res cond_type = m_condition->get_type_checked(scope);
     if (!cond_type) {
         errors.emplace_back(std::move(cond_type.error()));
     }
@@ -68,12 +68,12 @@ void for_stmt::pseudo_racket(std::ostream& os) const {
         errors.emplace_back(std::move(*invalid_condition), m_condition.get());
     }
     
-    semantic_check_res incr_type = m_incr->get_type_checked(nested);
+    semantic_check_res incr_type = m_incr->get_type_checked(scope);
     if (!incr_type) {
         errors.emplace_back(std::move(incr_type.error()));
     }
 
-    std::vector<semantic_check_error> body_errors = m_body->check_semantics(nested);
+    std::vector<semantic_check_error> body_errors = m_body->check_semantics(scope);
     if (!body_errors.empty()) {
         errors.insert(errors.end(), body_errors.begin(), body_errors.end());
     }
@@ -84,9 +84,7 @@ void for_stmt::pseudo_racket(std::ostream& os) const {
 [[nodiscard]] emission_err for_stmt::emit_dc(compilation::function& fn, compilation::global_state& global) const noexcept {
     constexpr u8 BRANCH_PLACEHOLDER = 0xFF;
 
-    compilation::environment<reg_idx> old_saved = std::move(fn.m_varsToRegs);
-    compilation::environment<reg_idx> new_env(&old_saved);
-    fn.m_varsToRegs = std::move(new_env);
+    const compilation::environment<reg_idx>::nested_scope for_scope{fn.m_varsToRegs};
 
     // init
     // condition
@@ -127,12 +125,10 @@ void for_stmt::pseudo_racket(std::ostream& os) const {
     fn.emit_instruction(Opcode::Branch, start_branch_lo, 00, start_branch_hi);
     fn.free_register(*condition_reg);
 
-    for (const auto& [_, reg] : fn.m_varsToRegs.m_values) {
-        fn.free_lvalue_register(reg);
+    for (const auto& var : fn.m_varsToRegs.current_scope()) {
+        fn.free_lvalue_register(var.m_value);
     }
 
-    fn.m_varsToRegs = std::move(old_saved);
-
     return std::nullopt;
 }
 
@@ -156,4 +152,12 @@ MATCH_OPTIMIZATION_ACTION for_stmt::match_optimization_pass(match_optimization_e
     return m_body->match_optimization_pass(env);
 }
 
+void for_stmt::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::FOR);
+    writer.write(m_init);
+    writer.write(m_condition);
+    writer.write(m_incr);
+    writer.write(m_body);
+}
+
 }
\ No newline at end of file
@@ -48,4 +48,12 @@ MATCH_OPTIMIZATION_ACTION foreach_stmt::match_optimization_pass(match_optimizati
     return m_body->match_optimization_pass(env);
 }
 
+void foreach_stmt::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::FOREACH);
+    writer.write(m_var.m_type);
+    writer.write(m_var.m_name);
+    writer.write(m_iterable);
+    writer.write(m_body);
+}
+
 }
\ No newline at end of file
@@ -161,4 +161,12 @@ MATCH_OPTIMIZATION_ACTION if_stmt::match_optimization_pass(match_optimization_en
     }
     return MATCH_OPTIMIZATION_ACTION::NONE;
 }
+
+void if_stmt::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::IF);
+    writer.write(m_condition);
+    writer.write(m_then);
+    writer.write(m_else);
+}
+
 }
\ No newline at end of file
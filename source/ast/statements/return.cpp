@@ -84,4 +84,9 @@ MATCH_OPTIMIZATION_ACTION return_stmt::match_optimization_pass(match_optimizatio
     return MATCH_OPTIMIZATION_ACTION::NONE;
 }
 
+void return_stmt::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::RETURN);
+    writer.write(m_expr);
+}
+
 }
\ No newline at end of file
@@ -53,7 +53,7 @@ void variable_declaration::pseudo_racket(std::ostream& os) const {
             return {semantic_check_error{*assign_err}};
         }
     }
-    scope.define(m_identifier, m_type);
+    scope.define(m_symbol, m_type);
 
     return {};
 }
@@ -63,8 +63,8 @@ void variable_declaration::pseudo_racket(std::ostream& os) const {
     if (!new_var_reg) {
         return new_var_reg.error();
     }
-    assert(!fn.m_varsToRegs.lookup(m_identifier));
-    fn.m_varsToRegs.define(m_identifier, *new_var_reg);
+    assert(!fn.m_varsToRegs.lookup(m_symbol));
+    fn.m_varsToRegs.define(m_symbol, *new_var_reg);
 
     if (m_init) {
         const emission_res init_emit = m_init->emit_dc(fn, global, *new_var_reg);
@@ -79,10 +79,10 @@ VAR_OPTIMIZATION_ACTION variable_declaration::var_optimization_pass(var_optimiza
     if (m_init) {
         env.check_action(&m_init);
     }
-    if (!m_identifier.starts_with("var") || env.m_env.m_values.contains(m_identifier)) {
+    if (!m_identifier.starts_with("var") || env.m_env.defines(m_symbol)) {
         return VAR_OPTIMIZATION_ACTION::NONE;
     }
-    env.m_env.define(m_identifier, {});
+    env.m_env.define(m_symbol, {});
     return VAR_OPTIMIZATION_ACTION::VAR_DECLARATION;
 }
 
@@ -97,4 +97,11 @@ MATCH_OPTIMIZATION_ACTION variable_declaration::match_optimization_pass(match_op
     return !m_init ? MATCH_OPTIMIZATION_ACTION::RESULT_VAR_DECLARATION : MATCH_OPTIMIZATION_ACTION::NONE;
 }
 
+void variable_declaration::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::VARIABLE_DECLARATION);
+    writer.write(m_type);
+    writer.write(m_identifier);
+    writer.write(m_init);
+}
+
 }
\ No newline at end of file
@@ -116,4 +116,10 @@ MATCH_OPTIMIZATION_ACTION while_stmt::match_optimization_pass(match_optimization
     return m_body->match_optimization_pass(env);
 }
 
+void while_stmt::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::WHILE);
+    writer.write(m_condition);
+    writer.write(m_body);
+}
+
 }
\ No newline at end of file
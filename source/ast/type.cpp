@@ -1,20 +1,22 @@
 #include "ast/type.h"
 #include <sstream>
 #include <numeric>
+#include <array>
+#include <unordered_map>
 
 namespace dconstruct::ast {
 
-function_type::function_type() noexcept : m_return{ std::make_shared<ast::full_type>(std::monostate()) } {}
+function_type::function_type() noexcept : m_return{ intern_type(std::monostate()) } {}
 
 function_type::function_type(ref_full_type return_type, t_arg_list args) noexcept
     : m_return{ std::move(return_type) }, m_arguments{ std::move(args) } {}
 
-ptr_type::ptr_type() noexcept : m_pointedAt{ std::make_shared<ast::full_type>(std::monostate()) } {}
+ptr_type::ptr_type() noexcept : m_pointedAt{ intern_type(std::monostate()) } {}
 
 ptr_type::ptr_type(ref_full_type&& type) noexcept : m_pointedAt{ std::move(type) } {}
 
 ptr_type::ptr_type(const ast::primitive_kind& kind) noexcept
-    : m_pointedAt{ std::make_shared<ast::full_type>(make_type_from_prim(kind)) } {}
+    : m_pointedAt{ intern_type(make_type_from_prim(kind)) } {}
 
 [[nodiscard]] full_type make_type_from_prim(const primitive_kind kind) {
     return full_type{ primitive_type{ kind } };
@@ -27,9 +29,71 @@ ptr_type::ptr_type(const ast::primitive_kind& kind) noexcept
 [[nodiscard]] function_type make_function(const ast::full_type& return_arg, const std::initializer_list<std::pair<std::string, full_type>>& args) {
     ast::function_type::t_arg_list arg_types;
     for (const auto& [name, type] : args) {
-        arg_types.emplace_back(name, std::make_shared<full_type>(type));
+        arg_types.emplace_back(name, intern_type(type));
     }
-    return function_type{ std::make_shared<ast::full_type>(return_arg), std::move(arg_types) };
+    return function_type{ intern_type(return_arg), std::move(arg_types) };
+}
+
+[[nodiscard]] static u64 combine_type_hash(const u64 seed, const u64 value) noexcept {
+    return seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+}
+
+[[nodiscard]] static u64 hash_type(const full_type& type) noexcept {
+    return std::visit([&type](auto&& t) -> u64 {
+        using T = std::decay_t<decltype(t)>;
+        u64 res = type.index();
+        if constexpr (std::is_same_v<T, primitive_type>) {
+            res = combine_type_hash(res, static_cast<u64>(t.m_type));
+        } else if constexpr (std::is_same_v<T, struct_type> || std::is_same_v<T, enum_type>) {
+            res = combine_type_hash(res, std::hash<std::string>{}(t.m_name));
+        } else if constexpr (std::is_same_v<T, ptr_type>) {
+            res = combine_type_hash(res, t.m_pointedAt ? hash_type(*t.m_pointedAt) : 0);
+        } else if constexpr (std::is_same_v<T, function_type>) {
+            res = combine_type_hash(res, t.m_return ? hash_type(*t.m_return) : 0);
+            for (const auto& [name, arg] : t.m_arguments) {
+                res = combine_type_hash(res, arg ? hash_type(*arg) : 0);
+            }
+            res = combine_type_hash(res, t.m_isFarCall);
+        }
+        return res;
+    }, type);
+}
+
+// one per thread, so interning never takes a lock and the nodes' reference counts are only touched by the thread that uses them
+struct type_interner {
+    ref_full_type m_unknown = std::make_shared<full_type>(std::monostate());
+    std::array<ref_full_type, static_cast<u64>(primitive_kind::NOTHING) + 1> m_primitives;
+    std::unordered_multimap<u64, ref_full_type> m_compound;
+
+    type_interner() {
+        for (u64 i = 0; i < m_primitives.size(); ++i) {
+            m_primitives[i] = std::make_shared<full_type>(make_type_from_prim(static_cast<primitive_kind>(i)));
+        }
+    }
+
+    [[nodiscard]] const ref_full_type& intern(const full_type& type) {
+        // unknown and primitive types make up nearly everything, those never need a lookup
+        if (is_unknown(type)) {
+            return m_unknown;
+        }
+        if (const auto* prim = std::get_if<primitive_type>(&type)) {
+            return m_primitives[static_cast<u64>(prim->m_type)];
+        }
+
+        const u64 hash = hash_type(type);
+        const auto [begin, end] = m_compound.equal_range(hash);
+        for (auto it = begin; it != end; ++it) {
+            if (*it->second == type) {
+                return it->second;
+            }
+        }
+        return m_compound.emplace(hash, std::make_shared<full_type>(type))->second;
+    }
+};
+
+[[nodiscard]] ref_full_type intern_type(const full_type& type) {
+    thread_local type_interner interner;
+    return interner.intern(type);
 }
 
 [[nodiscard]] primitive_kind kind_from_primitive_value(const primitive_value& prim) noexcept {
@@ -111,8 +111,14 @@ void sizeof_expr::pseudo_racket(std::ostream& os) const {
     return FOREACH_OPTIMIZATION_ACTION::NONE;
 }
 
-
-
-
+void sizeof_expr::serialize(ast_writer& writer) const {
+    writer.write(NODE_KIND::SIZEOF);
+    writer.write(static_cast<u8>(m_operand.index()));
+    if (const auto* type = std::get_if<full_type>(&m_operand)) {
+        writer.write(*type);
+    } else {
+        writer.write(std::get<expr_uptr>(m_operand));
+    }
+}
 
 }
\ No newline at end of file
@@ -7,6 +7,10 @@
 #include <cstring>
 #include <chrono>
 #include <numeric>
+#include <algorithm>
+#include <bit>
+#include <string_view>
+#include <thread>
 
 namespace dconstruct {
 
@@ -82,6 +86,226 @@ namespace dconstruct {
     }
 
 
+    [[nodiscard]] const struct_table_entry* struct_table::find(const u32 offset) const noexcept {
+        const auto it = std::lower_bound(m_entries.begin(), m_entries.end(), offset, [](const struct_table_entry& entry, const u32 off) {
+            return entry.m_offset < off;
+        });
+        if (it == m_entries.end() || it->m_offset != offset) {
+            return nullptr;
+        }
+        return &*it;
+    }
+
+
+    [[nodiscard]] std::span<const u32> struct_table::pointer_slots(const struct_table_entry& entry) const noexcept {
+        return std::span<const u32>(m_pointerSlots.data() + entry.m_firstPointerSlot, entry.m_numPointerSlots);
+    }
+
+
+    [[nodiscard]] std::span<const u32> struct_table::referrers(const struct_table_entry& entry) const noexcept {
+        return std::span<const u32>(m_referrers.data() + entry.m_firstReferrer, entry.m_numReferrers);
+    }
+
+
+    [[nodiscard]] bool BinaryFile::is_emitted(const location loc) const noexcept {
+        const p64 offset = (loc.num() - reinterpret_cast<p64>(m_bytes.get())) / 8;
+        return (u8)m_emittedTable[offset / 8] & (1 << (offset % 8));
+    }
+
+
+    void BinaryFile::set_emitted(const location loc) noexcept {
+        const p64 offset = (loc.num() - reinterpret_cast<p64>(m_bytes.get())) / 8;
+        reinterpret_cast<u8*>(m_emittedTable.get())[offset / 8] |= (1 << (offset % 8));
+    }
+
+
+    [[nodiscard]] static u64 get_content_hash(const location loc, const u32 size, const u32 num_elements) noexcept {
+        const u64 hash = std::hash<std::string_view>{}(std::string_view(loc.as<char>(), size));
+        return hash ^ (static_cast<u64>(size) << 32 | num_elements);
+    }
+
+
+    [[nodiscard]] std::optional<u32> BinaryFile::find_emitted_content(const location loc, const u32 size, const u32 num_elements) const noexcept {
+        const auto [begin, end] = m_emittedContents.equal_range(get_content_hash(loc, size, num_elements));
+        for (auto it = begin; it != end; ++it) {
+            const emitted_content& content = it->second;
+            if (content.m_size == size && content.m_numElements == num_elements && std::memcmp(m_bytes.get() + content.m_offset, loc.m_ptr, size) == 0) {
+                return content.m_offset;
+            }
+        }
+        return std::nullopt;
+    }
+
+
+    void BinaryFile::add_emitted_content(const location loc, const u32 size, const u32 num_elements) {
+        const u32 offset = static_cast<u32>(loc.num() - reinterpret_cast<p64>(m_bytes.get()));
+        m_emittedContents.emplace(get_content_hash(loc, size, num_elements), emitted_content{offset, size, num_elements});
+    }
+
+
+    // offsets of every 4 byte aligned occurence of value in [begin, end)
+    static void find_u32_in_range(const std::byte* bytes, const u64 begin, const u64 end, const u32 value, std::vector<u64>& out) {
+        u64 i = begin;
+#ifdef __AVX2__
+        const __m256i pattern = _mm256_set1_epi32(static_cast<i32>(value));
+        for (; i + 32 <= end; i += 32) {
+            const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+            u32 mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(data, pattern)));
+            for (; mask != 0; mask &= mask - 1) {
+                out.push_back(i + std::countr_zero(mask) * 4);
+            }
+        }
+#else
+        const __m128i pattern = _mm_set1_epi32(static_cast<i32>(value));
+        for (; i + 16 <= end; i += 16) {
+            const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+            u32 mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(data, pattern)));
+            for (; mask != 0; mask &= mask - 1) {
+                out.push_back(i + std::countr_zero(mask) * 4);
+            }
+        }
+#endif
+        for (; i + 4 <= end; i += 4) {
+            if (*reinterpret_cast<const u32*>(bytes + i) == value) {
+                out.push_back(i);
+            }
+        }
+    }
+
+
+    [[nodiscard]] std::vector<u64> BinaryFile::find_u32(const u32 value, const u32 max_threads) const {
+        const u64 num_threads = std::clamp<u64>(m_size / FIND_U32_MIN_BYTES_PER_THREAD, 1, std::max(1u, max_threads));
+
+        if (num_threads == 1) {
+            std::vector<u64> offsets;
+            find_u32_in_range(m_bytes.get(), 0, m_size, value, offsets);
+            return offsets;
+        }
+
+        const u64 chunk_size = (m_size / num_threads + 63) & ~63ULL;
+        std::vector<std::vector<u64>> chunk_offsets(num_threads);
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(num_threads);
+            for (u64 t = 0; t < num_threads; ++t) {
+                const u64 begin = std::min(t * chunk_size, m_size);
+                const u64 end = t + 1 == num_threads ? m_size : std::min(begin + chunk_size, m_size);
+                workers.emplace_back(find_u32_in_range, m_bytes.get(), begin, end, value, std::ref(chunk_offsets[t]));
+            }
+        }
+
+        std::vector<u64> offsets;
+        for (const auto& chunk : chunk_offsets) {
+            offsets.insert(offsets.end(), chunk.begin(), chunk.end());
+        }
+        return offsets;
+    }
+
+
+    [[nodiscard]] const struct_table_entry* BinaryFile::get_struct(const location loc) const noexcept {
+        const p64 offset = loc.num() - reinterpret_cast<p64>(m_bytes.get());
+        if (offset >= m_size) {
+            return nullptr;
+        }
+        return m_structs.find(static_cast<u32>(offset));
+    }
+
+
+    [[nodiscard]] u32 BinaryFile::get_array_size(const struct_table_entry& entry) const noexcept {
+        const u32 strings_offset = static_cast<u32>(m_strings.num() - reinterpret_cast<p64>(m_bytes.get()));
+        // the entry ends in front of the next pointed-at location's type ID. only if that location lies before the string table
+        // does it have one, otherwise the array is scanned in whole qwords up to the string table
+        if (entry.m_offset + entry.m_size + 8 < strings_offset) {
+            return entry.m_size;
+        }
+        return ((strings_offset + 7) & ~7u) - entry.m_offset;
+    }
+
+
+    void BinaryFile::build_struct_table(const SIDBase& sidbase) {
+        m_structs = struct_table{};
+
+        const u32 table_size = m_relocTable.get<u32>(-4);
+        const u8* pointed_at = reinterpret_cast<const u8*>(m_pointedAtTable.get());
+        const u8* reloc_bits = m_relocTable.as<u8>();
+        const u64 strings_offset = m_strings.num() - reinterpret_cast<p64>(m_bytes.get());
+
+        // a struct ends where the next pointed-at location's type ID begins, so the locations just past the string table start matter too
+        std::vector<u32> pointed_at_offsets;
+        for (u64 byte = 0; byte < table_size && byte * 64 < strings_offset + 8; ++byte) {
+            for (u8 bits = pointed_at[byte]; bits != 0; bits &= bits - 1) {
+                pointed_at_offsets.push_back(static_cast<u32>(byte * 64 + std::countr_zero(bits) * 8));
+            }
+        }
+
+        for (u64 i = 0; i < pointed_at_offsets.size() && pointed_at_offsets[i] < strings_offset; ++i) {
+            const u32 offset = pointed_at_offsets[i];
+            const u64 next = i + 1 < pointed_at_offsets.size() ? pointed_at_offsets[i + 1] - 8 : strings_offset;
+            const u64 end = std::min(next, strings_offset);
+
+            sid64 type_id = 0;
+            if (offset >= 8) {
+                const location header = location(m_bytes.get() + offset - 8);
+                const sid64 header_sid = header.get<sid64>();
+                if (header_sid >= sidbase.m_lowestSid && header_sid <= sidbase.m_highestSid && !is_file_ptr(header)) {
+                    type_id = header_sid;
+                }
+            }
+            m_structs.m_entries.push_back(struct_table_entry{
+                .m_offset = offset,
+                .m_size = static_cast<u32>(end > offset ? end - offset : 0),
+                .m_typeId = type_id,
+                .m_firstPointerSlot = 0,
+                .m_numPointerSlots = 0,
+                .m_firstReferrer = 0,
+                .m_numReferrers = 0
+            });
+        }
+
+        std::vector<u32> slots;
+        for (u64 byte = 0; byte < table_size; ++byte) {
+            for (u8 bits = reloc_bits[byte]; bits != 0; bits &= bits - 1) {
+                slots.push_back(static_cast<u32>(byte * 64 + std::countr_zero(bits) * 8));
+            }
+        }
+
+        std::vector<u32> referrer_counts(m_structs.m_entries.size() + 1, 0);
+        std::vector<u32> slot_targets(slots.size(), UINT32_MAX);
+        u64 entry_idx = 0;
+        for (u64 i = 0; i < slots.size(); ++i) {
+            const u32 slot = slots[i];
+            while (entry_idx < m_structs.m_entries.size() && slot >= m_structs.m_entries[entry_idx].m_offset + m_structs.m_entries[entry_idx].m_size) {
+                ++entry_idx;
+            }
+            if (entry_idx < m_structs.m_entries.size() && slot >= m_structs.m_entries[entry_idx].m_offset) {
+                struct_table_entry& owner = m_structs.m_entries[entry_idx];
+                if (owner.m_numPointerSlots++ == 0) {
+                    owner.m_firstPointerSlot = static_cast<u32>(m_structs.m_pointerSlots.size());
+                }
+                m_structs.m_pointerSlots.push_back(slot);
+            }
+
+            const p64 target = *reinterpret_cast<const p64*>(m_bytes.get() + slot) - reinterpret_cast<p64>(m_bytes.get());
+            if (const struct_table_entry* pointee = m_structs.find(static_cast<u32>(target)); pointee != nullptr && target < m_size) {
+                slot_targets[i] = static_cast<u32>(pointee - m_structs.m_entries.data());
+                ++referrer_counts[slot_targets[i] + 1];
+            }
+        }
+
+        std::partial_sum(referrer_counts.begin(), referrer_counts.end(), referrer_counts.begin());
+        m_structs.m_referrers.resize(referrer_counts.back());
+        for (u64 i = 0; i < m_structs.m_entries.size(); ++i) {
+            m_structs.m_entries[i].m_firstReferrer = referrer_counts[i];
+        }
+        for (u64 i = 0; i < slots.size(); ++i) {
+            if (slot_targets[i] != UINT32_MAX) {
+                struct_table_entry& pointee = m_structs.m_entries[slot_targets[i]];
+                m_structs.m_referrers[pointee.m_firstReferrer + pointee.m_numReferrers++] = slots[i];
+            }
+        }
+    }
+
+
     // void print_m512i(__m512i *var) {
     //     alignas(64) uint64_t val[8];  // 512 bits = 8 * 64 bits
     //     _mm512_store_epi64((__m512i*)val, *var);
@@ -98,6 +322,7 @@ namespace dconstruct {
 
         const u32 table_size = *reinterpret_cast<u32*>(reloc_data);
         m_pointedAtTable = std::make_unique<std::byte[]>(table_size);
+        m_emittedTable = std::make_unique<std::byte[]>(table_size);
 
         m_relocTable = location(reloc_data + 4);
 
@@ -2,6 +2,7 @@
 #include <fstream>
 #include <filesystem>
 #include <iostream>
+#include <algorithm>
 
 namespace dconstruct {
 
@@ -27,7 +28,14 @@ namespace dconstruct {
         const sid64 lowest = entries[0].hash;
         const sid64 highest = entries[num_entries - 1].hash;
 
-        return SIDBase{num_entries, std::move(bytes), entries, lowest, highest};
+        SIDBase base{num_entries, std::move(bytes), entries, lowest, highest};
+        if (highest <= UINT32_MAX) {
+            base.m_sids32.reserve(num_entries);
+            for (u64 i = 0; i < num_entries; ++i) {
+                base.m_sids32.push_back(static_cast<sid32>(entries[i].hash));
+            }
+        }
+        return base;
     }
 
     [[nodiscard]] const char* SIDBase::search(const sid64 hash) const noexcept {
@@ -50,7 +58,33 @@ namespace dconstruct {
         return nullptr;
     }
 
+    [[nodiscard]] const char* SIDBase::search(const sid32 hash) const noexcept {
+        if (m_sids32.empty()) {
+            return search(static_cast<sid64>(hash));
+        }
+        const auto it = std::lower_bound(m_sids32.begin(), m_sids32.end(), hash);
+        if (it == m_sids32.end() || *it != hash) {
+            return nullptr;
+        }
+        return reinterpret_cast<const char*>(m_sidbytes.get() + m_entries[it - m_sids32.begin()].offset);
+    }
+
     [[nodiscard]] bool SIDBase::sid_exists(const sid64 hash) const noexcept {
         return search(hash) != nullptr;
     }
+
+    [[nodiscard]] u64 SIDBase::get_digest() const noexcept {
+        u64 digest = 0xCBF29CE484222325;
+        const auto mix = [&digest](const u64 value) {
+            digest = (digest ^ value) * 0x100000001B3;
+        };
+        mix(m_numEntries);
+        for (u64 i = 0; i < m_numEntries; ++i) {
+            mix(m_entries[i].hash);
+            for (const char* c = reinterpret_cast<const char*>(m_sidbytes.get() + m_entries[i].offset); *c != '\0'; ++c) {
+                mix(static_cast<u8>(*c));
+            }
+        }
+        return digest;
+    }
 }
\ No newline at end of file
@@ -139,9 +139,9 @@ const token* Parser::consume(const token_type type, const std::string& message)
         return std::nullopt;
     }
     ast::function_type func_type;
-    func_type.m_return = std::make_unique<ast::full_type>(std::move(*return_type));
+    func_type.m_return = ast::intern_type(*return_type);
     for (auto& param_type : param_types) {
-        func_type.m_arguments.emplace_back("", std::make_unique<ast::full_type>(std::move(param_type)));
+        func_type.m_arguments.emplace_back("", ast::intern_type(param_type));
     }
     return func_type;
 }
@@ -161,7 +161,7 @@ const token* Parser::consume(const token_type type, const std::string& message)
     ast::full_type res = m_knownTypes.at(type_name);
 
     while (match({token_type::STAR}) && !is_at_end()) {
-        res = ast::ptr_type{std::make_unique<ast::full_type>(std::move(res))};
+        res = ast::ptr_type{ast::intern_type(res)};
     }
 
     return res;
@@ -188,7 +188,7 @@ const token* Parser::consume(const token_type type, const std::string& message)
     ast::full_type res = m_knownTypes.at(type_name);
 
     while (match({token_type::STAR}) && !is_at_end()) {
-        res = ast::ptr_type{std::make_unique<ast::full_type>(std::move(res))};
+        res = ast::ptr_type{ast::intern_type(res)};
     }
     
     return res;
@@ -236,7 +236,7 @@ const token* Parser::consume(const token_type type, const std::string& message)
         if (!decl) {
             return std::nullopt;
         }
-        struct_t.m_members[decl->m_identifier] = std::make_unique<ast::full_type>(std::move(decl->m_type));
+        struct_t.m_members[decl->m_identifier] = ast::intern_type(decl->m_type);
     }
 
     if (!consume(token_type::RIGHT_BRACE, "expected '}' after struct definition")) {
@@ -295,7 +295,7 @@ const token* Parser::consume(const token_type type, const std::string& message)
 
     std::unique_ptr<ast::function_definition> func_def = std::make_unique<ast::function_definition>();
     func_def->m_name = func_name->m_lexeme;
-    func_def->m_type.m_return = std::make_unique<ast::full_type>(std::move(*return_type));
+    func_def->m_type.m_return = ast::intern_type(*return_type);
 
     while (!check(token_type::RIGHT_PAREN) && !is_at_end()) {
         std::optional<ast::full_type> param_type = make_type();
@@ -4,7 +4,9 @@ namespace dconstruct::compilation {
 
 
 [[nodiscard]] bool token::operator==(const token &rhs) const {
-    return m_type == rhs.m_type && m_lexeme == rhs.m_lexeme && m_literal == rhs.m_literal && m_line == rhs.m_line;
+    // identifiers with the same symbol have the same lexeme
+    const bool same_lexeme = m_symbol != symbol_table::invalid_symbol ? m_symbol == rhs.m_symbol : m_lexeme == rhs.m_lexeme;
+    return m_type == rhs.m_type && same_lexeme && m_literal == rhs.m_literal && m_line == rhs.m_line;
 }
 
 }
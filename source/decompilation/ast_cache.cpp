@@ -0,0 +1,100 @@
+#include "decompilation/ast_cache.h"
+#include "ast/serialization.h"
+#include "buildinfo.h"
+#include <format>
+#include <fstream>
+#include <thread>
+
+namespace dconstruct::dcompiler {
+
+    // any rebuild can change the decompiled code, so entries of other builds are never used
+    static constexpr char BUILD_ID[] = VERSION " " BUILD_DATE;
+
+
+    [[nodiscard]] u64 ast_cache::get_key(const std::byte* bytes, const std::size_t size, const bool optimize, const bool is_64_bit) const noexcept {
+        u64 hash = 0xCBF29CE484222325;
+        for (std::size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<u8>(bytes[i]);
+            hash *= 0x100000001B3;
+        }
+        hash ^= m_sidbaseDigest + 0x9E3779B97F4A7C15 + (hash << 6) + (hash >> 2);
+        return hash ^ static_cast<u64>(optimize) ^ (static_cast<u64>(is_64_bit) << 1);
+    }
+
+
+    [[nodiscard]] std::filesystem::path ast_cache::get_entry_path(const u64 key) const {
+        return m_dir / std::format("{:016X}.ast", key);
+    }
+
+
+    [[nodiscard]] std::expected<cached_functions, std::string> ast_cache::load(const u64 key) const {
+        const std::filesystem::path path = get_entry_path(key);
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in.is_open()) {
+            return std::unexpected{"no cache entry at '" + path.string() + "'\n"};
+        }
+
+        std::vector<std::byte> data(static_cast<std::size_t>(in.tellg()));
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!in) {
+            return std::unexpected{"couldn't read cache entry '" + path.string() + "'\n"};
+        }
+
+        ast::ast_reader reader{data};
+        const u32 magic = reader.read<u32>();
+        const u32 version = reader.read<u32>();
+        const std::string build_id = reader.read_string();
+        if (reader.failed() || magic != CACHE_MAGIC || version != CACHE_VERSION || build_id != BUILD_ID) {
+            return std::unexpected{"'" + path.string() + "' is not an ast cache entry or was written by a different build\n"};
+        }
+
+        cached_functions res;
+        res.m_scriptMetadata = reader.read_string();
+        const u32 num_functions = reader.read_count();
+        res.m_functions.reserve(num_functions);
+        for (u32 i = 0; i < num_functions && !reader.failed(); ++i) {
+            res.m_functions.push_back(reader.read_function());
+        }
+        if (reader.failed() || !reader.at_end()) {
+            return std::unexpected{"ast cache entry '" + path.string() + "' is corrupt\n"};
+        }
+        return res;
+    }
+
+
+    [[nodiscard]] std::expected<void, std::string> ast_cache::save(const u64 key, const std::vector<ast::function_definition>& functions, const std::string& script_metadata) const {
+        ast::ast_writer writer;
+        writer.write(CACHE_MAGIC);
+        writer.write(CACHE_VERSION);
+        writer.write(std::string{BUILD_ID});
+        writer.write(script_metadata);
+        writer.write(static_cast<u32>(functions.size()));
+        for (const auto& func : functions) {
+            writer.write(func);
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(m_dir, ec);
+        // written under a temporary name first, so an interrupted write never leaves a half written entry behind
+        const std::filesystem::path path = get_entry_path(key);
+        std::filesystem::path tmp_path = path;
+        tmp_path += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        {
+            std::ofstream out(tmp_path, std::ios::binary);
+            if (!out.is_open()) {
+                return std::unexpected{"couldn't write ast cache entry to '" + tmp_path.string() + "'\n"};
+            }
+            out.write(reinterpret_cast<const char*>(writer.data().data()), static_cast<std::streamsize>(writer.data().size()));
+            if (!out) {
+                return std::unexpected{"couldn't write ast cache entry to '" + tmp_path.string() + "'\n"};
+            }
+        }
+        std::filesystem::rename(tmp_path, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmp_path, ec);
+            return std::unexpected{"couldn't move ast cache entry to '" + path.string() + "'\n"};
+        }
+        return {};
+    }
+}
@@ -1,17 +1,15 @@
-#ifdef WIN32
-#define GVDLL
-#endif
-
 #include "decompilation/control_flow_graph.h"
+#include "decompilation/graph_layout.h"
 
 #include <fstream>
 #include <iostream>
-#include <graphviz/gvc.h>
-#include <graphviz/cgraph.h>
 #include <sstream>
-#include <mutex>
+#include <iomanip>
+#include <cmath>
+#include <limits>
 #include <algorithm>
 #include <functional>
+#include <utility>
 
 //#define _TRACE
 
@@ -40,12 +38,10 @@ namespace dconstruct {
 
 
     [[nodiscard]] const control_flow_loop* ControlFlowGraph::get_loop_with_head(const node_id node) const {
-        for (const auto& loop : m_loops) {
-            if (loop.m_headNode == node) {
-                return &loop;
-            }
+        if (node >= m_loopWithHead.size() || m_loopWithHead[node] == control_flow_loop::invalid_loop) {
+            return nullptr;
         }
-        return nullptr;
+        return &m_loops[m_loopWithHead[node]];
     }
 
     static std::string html_escape(const std::string& input) {
@@ -68,26 +64,6 @@ namespace dconstruct {
         return output;
     }
 
-    [[nodiscard]] std::string control_flow_node::get_label_html() const {
-        std::stringstream ss;
-
-        ss << R"(<TABLE BORDER="0" CELLBORDER="1" CELLSPACING="0" CELLPADDING="12">"
-        "<TR><TD ALIGN="LEFT" BALIGN="LEFT"><FONT FACE="Consolas">)";
-
-#ifdef _TRACE
-        ss << std::hex << "idx: " << m_index << "  ipdom: " << m_ipdom << "  postorder: " << m_postorder << std::dec << "<BR/>";
-#endif
-
-        for (const auto& line : m_lines) {
-            ss << line.m_text << " " << html_escape(line.m_comment) << "&#160;&#160;<BR/>";
-        }
-
-        ss << "</FONT></TD></TR></TABLE>";
-
-
-        return ss.str();
-    }
-
     [[nodiscard]] bool control_flow_node::operator==(const control_flow_node& rhs) const noexcept {
         if (m_lines.size() != rhs.m_lines.size()) {
             return false;
@@ -175,12 +151,6 @@ namespace dconstruct {
         return {read_first, multi_read, write_regs};
     }
 
-    static void insert_node_at_line(const istr_line start_line, std::map<node_id, control_flow_node>& nodes) {
-        if (!nodes.contains(start_line)) {
-            nodes.emplace(start_line, start_line);
-        }
-    }
-
     [[nodiscard]] std::vector<node_id> postorder(const std::vector<control_flow_node>& nodes) {
         std::vector<node_id> result;
         const u32 size = nodes.size();
@@ -214,77 +184,87 @@ namespace dconstruct {
 
 
     [[nodiscard]] ControlFlowGraph ControlFlowGraph::build(const function_disassembly& func) noexcept {
-        const std::vector<u32> &labels = func.m_stackFrame.m_labels;
-        std::map<node_id, control_flow_node> nodes;
-        nodes.emplace(0, 0);
-        node_id current_node = 0;
-        node_id following_node;
-        for (u32 i = 0; i < func.m_lines.size(); ++i) {
-            const function_disassembly_line &current_line = func.m_lines[i];
-            nodes[current_node].m_lines.push_back(current_line);
-            if (i == func.m_lines.size() - 1) {
-                nodes[current_node].m_endLine = current_line.m_location;
-                break;
+        const auto& lines = func.m_lines;
+        const u32 line_count = lines.size();
+
+        // first pass: a line starts a node if it's a label, a branch target or follows a branch
+        node_set is_leader(std::max(line_count, 1u), false);
+        is_leader[0] = true;
+        for (const u32 label : func.m_stackFrame.m_labels) {
+            if (label < line_count) {
+                is_leader[label] = true;
             }
-            const function_disassembly_line &next_line = func.m_lines[i + 1];
-
-            bool next_line_is_target = std::find(labels.begin(), labels.end(), next_line.m_location) != labels.end();
-
-            if (current_line.m_target != control_flow_node::invalid_node) {
-                insert_node_at_line(current_line.m_target, nodes);
-                nodes[current_node].m_targetNode = current_line.m_target;
-                nodes[current_line.m_target].m_predecessors.push_back(current_node);
-
-                following_node = next_line.m_location;
+        }
+        for (u32 i = 0; i + 1 < line_count; ++i) {
+            if (lines[i].m_target != control_flow_node::invalid_node) {
+                if (lines[i].m_target < line_count) {
+                    is_leader[lines[i].m_target] = true;
+                }
+                is_leader[i + 1] = true;
+            }
+        }
 
-                insert_node_at_line(following_node, nodes);
+        // second pass: emit the nodes in line order, so a node's index is its position in m_nodes
+        std::vector<node_id> line_to_node(is_leader.size(), control_flow_node::invalid_node);
+        std::vector<control_flow_node> nodes;
+        nodes.reserve(std::count(is_leader.begin(), is_leader.end(), true));
+        for (u32 i = 0; i < is_leader.size(); ++i) {
+            if (is_leader[i]) {
+                line_to_node[i] = nodes.size();
+                nodes.emplace_back(i).m_index = line_to_node[i];
+            }
+        }
 
-                if (current_line.m_instruction.opcode != Opcode::Branch) {
-                    nodes[current_node].m_followingNode = following_node;
-                    nodes[following_node].m_predecessors.push_back(current_node);
+        std::vector<u32> predecessor_offsets(nodes.size() + 1, 0);
+        for (node_id i = 0; line_count != 0 && i < nodes.size(); ++i) {
+            auto& node = nodes[i];
+            const u32 last_line = i + 1 < nodes.size() ? nodes[i + 1].m_startLine - 1 : line_count - 1;
+            node.m_lines = std::span(lines.data() + node.m_startLine, last_line - node.m_startLine + 1);
+            const function_disassembly_line& end_line = node.m_lines.back();
+            node.m_endLine = end_line.m_location;
+            if (last_line + 1 == line_count) {
+                continue;
+            }
+            if (end_line.m_target < line_count) {
+                node.m_targetNode = line_to_node[end_line.m_target];
+                predecessor_offsets[node.m_targetNode + 1]++;
+                if (end_line.m_instruction.opcode == Opcode::Branch) {
+                    continue;
                 }
+            }
+            node.m_followingNode = i + 1;
+            predecessor_offsets[i + 2]++;
+        }
 
-                nodes[current_node].m_endLine = current_line.m_location;
-                current_node = following_node;
-            }
-            else if (next_line_is_target) {
-                following_node = next_line.m_location;
-                insert_node_at_line(following_node, nodes);
-                nodes[current_node].m_followingNode = following_node;
-                nodes[following_node].m_predecessors.push_back(current_node);
-                nodes[current_node].m_endLine = current_line.m_location;
-                current_node = following_node;
-            } 
-        }
-        std::vector<control_flow_node> ordered_nodes;
-        ordered_nodes.resize(nodes.size());
-        std::unordered_map<node_id, node_id> nodes_to_index;
-        u16 i = 0;
-        for (auto& [id, node] : nodes) {
-            nodes_to_index[id] = i;
-            node.m_index = i++;
-        }
-        for (auto& [id, node] : nodes) {
+        for (u32 i = 1; i < predecessor_offsets.size(); ++i) {
+            predecessor_offsets[i] += predecessor_offsets[i - 1];
+        }
+        std::vector<node_id> predecessor_list(predecessor_offsets.back());
+        std::vector<u32> insert_at(predecessor_offsets.begin(), predecessor_offsets.end() - 1);
+        for (auto& node : nodes) {
             if (node.has_target()) {
-                node.m_targetNode = nodes_to_index.at(node.m_targetNode);
+                predecessor_list[insert_at[node.m_targetNode]++] = node.m_index;
             }
             if (node.has_following()) {
-                node.m_followingNode = nodes_to_index.at(node.m_followingNode);
+                predecessor_list[insert_at[node.m_followingNode]++] = node.m_index;
             }
-            for (auto& pred : node.m_predecessors) {
-                pred = nodes_to_index.at(pred);
-            }
-            ordered_nodes[node.m_index] = node;
-            ordered_nodes[node.m_index].determine_register_nature();
+            node.determine_register_nature();
         }
         if (func.m_isScriptFunction) {
-            ordered_nodes.back().m_regs = ordered_nodes.back().get_register_nature_starting_at(0, false);
+            nodes.back().m_regs = nodes.back().get_register_nature_starting_at(0, false);
         }
 
-        ControlFlowGraph res(func, std::move(ordered_nodes));
+        ControlFlowGraph res(func, std::move(nodes), std::move(predecessor_list));
+        for (auto& node : res.m_nodes) {
+            const u32 first_pred = predecessor_offsets[node.m_index];
+            node.m_predecessors = std::span<const node_id>(res.m_predecessorList.data() + first_pred, predecessor_offsets[node.m_index + 1] - first_pred);
+        }
 
         res.compute_postdominators();
+        res.compute_dominators();
+        res.compute_liveness();
         res.find_loops();
+        res.find_regions();
 
         return res;
     }
@@ -314,263 +294,650 @@ namespace dconstruct {
             }
         }
     }
-    static std::mutex g_graphviz_mutex;
-
-    void ControlFlowGraph::write_image(const std::string& path) const {
-        GVC_t* gvc = gvContext();
-        Agraph_t* g = agopen((char*)"G", Agdirected, nullptr);
-        std::lock_guard lock(g_graphviz_mutex);
-        
-        const auto graph_nodes = insert_graphviz_nodes(g);
-
-        insert_graphviz_edges(g, graph_nodes);
-
-        Agraph_t* returng = agsubg(g, const_cast<char*>("return"), 1);
-        Agnode_t* return_node = agnode(returng, const_cast<char*>(std::to_string(m_nodes.back().m_index).c_str()), 1);
-
-        //insert_loop_subgraphs(g);
-
-        agsafeset(return_node, const_cast<char*>("peripheries"), "1", "");
-        agsafeset(returng, const_cast<char*>("rank"), "max", "");
-        agsafeset(g, const_cast<char*>("bgcolor"), background_color, const_cast<char*>(""));
-        agsafeset(g, const_cast<char*>("splines"), "ortho", const_cast<char*>(""));
-        gvLayout(gvc, g, "dot");
-        gvRenderFilename(gvc, g, "svg", path.c_str());
-        gvFreeLayout(gvc, g);
-        agclose(g);
-        gvFreeContext(gvc);
-    }
-
-    void ControlFlowGraph::insert_loop_subgraphs(Agraph_t *g) const {
-        for (u32 i = 0; i < m_loops.size(); ++i) {
-            const std::string loop_name = "cluster_loop_" + std::to_string(i);
-            Agraph_t *loopg = agsubg(g, const_cast<char *>(loop_name.c_str()), 1);
-
-            Agraph_t* loopheadg = agsubg(loopg, const_cast<char*>("head"), 1);
-            agnode(loopheadg, const_cast<char*>(std::to_string(m_loops[i].m_headNode).c_str()), 1);
-
-            Agraph_t* looplatchg = agsubg(loopg, const_cast<char*>("latch"), 1);
-            agnode(looplatchg, const_cast<char*>(std::to_string(m_loops[i].m_latchNode).c_str()), 1);
-
-            for (const auto &loop_node : m_loops[i].m_body) {
-                std::string name = std::to_string(loop_node);
-                agnode(loopg, name.data(), 1);
-            }
-            agsafeset(loopheadg, const_cast<char*>("rank"), "source", "");
-            agsafeset(looplatchg, const_cast<char*>("rank"), "max", "");
-            agsafeset(loopg, const_cast<char*>("label"), loop_name.c_str(), "");
-            agsafeset(loopg, const_cast<char*>("fontcolor"), accent_color, "");
-            agsafeset(loopg, const_cast<char*>("fontname"), "Consolas", "");
-            agsafeset(loopg, const_cast<char*>("color"), "purple", "");
-            agsafeset(loopg, const_cast<char*>("style"), "dashed", "");
+    static constexpr f32 FONT_SIZE = 14.f;
+    // advance of a consolas glyph at FONT_SIZE
+    static constexpr f32 GLYPH_WIDTH = 7.7f;
+    static constexpr f32 LINE_HEIGHT = 17.f;
+    static constexpr f32 NODE_PADDING = 12.f;
+    static constexpr f32 CLUSTER_PADDING = 12.f;
+    static constexpr f32 CLUSTER_LABEL_HEIGHT = 18.f;
+    static constexpr f32 ARROW_LENGTH = 10.f;
+    static constexpr f32 ARROW_WIDTH = 4.f;
+
+    [[nodiscard]] static u32 get_loop_nesting(const std::vector<control_flow_loop>& loops, const node_id loop) {
+        u32 nesting = 0;
+        for (const node_id child : loops[loop].m_children) {
+            nesting = std::max(nesting, get_loop_nesting(loops, child) + 1);
         }
+        return nesting;
     }
 
-    [[nodiscard]] std::vector<Agnode_t*> ControlFlowGraph::insert_graphviz_nodes(Agraph_t *g) const {
-        std::vector<Agnode_t*> ag_nodes;
-        ag_nodes.reserve(m_nodes.size());
+    [[nodiscard]] control_flow_image ControlFlowGraph::get_image() const {
+        control_flow_image image;
+        image.m_labels.reserve(m_nodes.size());
         for (const auto& node : m_nodes) {
-            std::string name = std::to_string(node.m_index);
-            Agnode_t* current_node = agnode(g, name.data(), 1);
-            ag_nodes.push_back(current_node);
-            const std::string node_html_label = node.get_label_html();
-
-            agsafeset_html(current_node, const_cast<char*>("label"), node_html_label.c_str(), "");
-
-            agsafeset(current_node, const_cast<char*>("fontcolor"), accent_color, "");
-            agsafeset(current_node, const_cast<char*>("shape"), "plaintext", "");
-            agsafeset(current_node, const_cast<char*>("color"), accent_color, "");
+            std::vector<std::string>& label = image.m_labels.emplace_back();
+#ifdef _TRACE
+            std::stringstream ss;
+            ss << std::hex << "idx: " << node.m_index << "  ipdom: " << node.m_ipdom << "  postorder: " << node.m_postorder;
+            label.push_back(ss.str());
+#endif
+            for (const auto& line : node.m_lines) {
+                label.push_back(line.m_text + " " + line.m_comment);
+            }
         }
-        return ag_nodes;
-    }
 
-    void ControlFlowGraph::insert_graphviz_edges(Agraph_t* g, const std::vector<Agnode_t*>& graph_nodes) const {
         for (const auto& node : m_nodes) {
+            // the only node of a function without lines is empty and has no edges
+            if (node.m_lines.empty()) {
+                continue;
+            }
             const auto node_start = node.m_index;
             const bool is_conditional = node.m_lines.back().m_instruction.opcode == Opcode::BranchIf || node.m_lines.back().m_instruction.opcode == Opcode::BranchIfNot;
 
             if (node.has_following()) {
-                Agedge_t* edge = agedge(g, graph_nodes[node_start], graph_nodes[node.m_followingNode], const_cast<char*>(""), 1);
-                agsafeset(edge, const_cast<char*>("color"), is_conditional ? conditional_false_color : fallthrough_color, "");
+                image.m_edges.push_back({ node_start, node.m_followingNode });
+                image.m_edgeColors.push_back(is_conditional ? conditional_false_color : fallthrough_color);
             }
             if (node.has_target()) {
-                Agedge_t* edge = agedge(g, graph_nodes[node_start], graph_nodes[node.m_targetNode], const_cast<char*>(""), 1);
+                image.m_edges.push_back({ node_start, node.m_targetNode });
                 if (node_start > node.m_targetNode) {
-                    agsafeset(edge, const_cast<char*>("color"), loop_upwards_color, "");
+                    image.m_edgeColors.push_back(loop_upwards_color);
                 } else if (node.m_lines.back().m_instruction.opcode == Opcode::Branch) {
-                    agsafeset(edge, const_cast<char*>("color"), branch_color, "");
+                    image.m_edgeColors.push_back(branch_color);
                 } else {
-                    agsafeset(edge, const_cast<char*>("color"), conditional_true_color, "");
+                    image.m_edgeColors.push_back(conditional_true_color);
                 }
             }
         }
+
+        image.m_loops.reserve(m_loops.size());
+        for (node_id i = 0; i < m_loops.size(); ++i) {
+            image.m_loops.push_back({ m_loops[i].m_body, m_loops[i].m_children, get_loop_nesting(m_loops, i), m_loops[i].m_parent == control_flow_loop::invalid_loop });
+        }
+        image.m_returnNode = m_nodes.back().m_index;
+        return image;
     }
 
-    void ControlFlowGraph::find_loops() {
-        for (const auto& loc : m_func.m_stackFrame.m_backwardsJumpLocs) {
-            const node_id loop_head = std::lower_bound(
-                m_nodes.begin(), 
-                m_nodes.end(), 
-                loc.m_target, 
-                [](const control_flow_node& node, const u64 target) -> bool { 
-                    return node.m_startLine < target;
-                }
-            )->m_index;
-            node_id loop_latch = 0;
-            for (const auto& node : m_nodes) {
-                if (node.m_endLine == loc.m_location) {
-                    loop_latch = node.m_index;
-                }
+    void ControlFlowGraph::write_image(const std::string& path) const {
+        get_image().write_svg(path);
+    }
+
+    void ControlFlowGraph::write_dot(const std::string& path) const {
+        get_image().write_dot(path);
+    }
+
+    // nodes, loop clusters & edges are laid out by layout_layered and written straight into the svg,
+    // nothing is shared between calls so every thread can render its own graphs
+    void control_flow_image::write_svg(const std::string& path) const {
+        std::vector<layout_point> sizes;
+        sizes.reserve(m_labels.size());
+        for (const auto& label : m_labels) {
+            u64 max_chars = 0;
+            for (const auto& line : label) {
+                max_chars = std::max(max_chars, line.size());
             }
-            m_loops.emplace_back(std::move(collect_loop_body(loop_head, loop_latch)), loop_head, loop_latch);
+            sizes.push_back({ max_chars * GLYPH_WIDTH + 2 * NODE_PADDING, label.size() * LINE_HEIGHT + 2 * NODE_PADDING });
+        }
+
+        const graph_layout layout = layout_layered(sizes, m_edges, m_returnNode);
+
+        struct cluster {
+            layout_point m_min;
+            layout_point m_max;
+        };
+        std::vector<cluster> clusters;
+        clusters.reserve(m_loops.size());
+        f32 min_x = 0.f, min_y = 0.f, max_x = layout.m_width, max_y = layout.m_height;
+        for (const auto& loop : m_loops) {
+            cluster c{ { std::numeric_limits<f32>::max(), std::numeric_limits<f32>::max() }, { 0.f, 0.f } };
+            for (const node_id node : loop.m_body) {
+                c.m_min.m_x = std::min(c.m_min.m_x, layout.m_nodes[node].m_x);
+                c.m_min.m_y = std::min(c.m_min.m_y, layout.m_nodes[node].m_y);
+                c.m_max.m_x = std::max(c.m_max.m_x, layout.m_nodes[node].m_x + sizes[node].m_x);
+                c.m_max.m_y = std::max(c.m_max.m_y, layout.m_nodes[node].m_y + sizes[node].m_y);
+            }
+            // loops around other loops get more room so their borders don't overlap
+            const f32 padding = CLUSTER_PADDING * (loop.m_nesting + 1);
+            c.m_min.m_x -= padding;
+            c.m_min.m_y -= padding + CLUSTER_LABEL_HEIGHT;
+            c.m_max.m_x += padding;
+            c.m_max.m_y += padding;
+            min_x = std::min(min_x, c.m_min.m_x - CLUSTER_PADDING);
+            min_y = std::min(min_y, c.m_min.m_y - CLUSTER_PADDING);
+            max_x = std::max(max_x, c.m_max.m_x + CLUSTER_PADDING);
+            max_y = std::max(max_y, c.m_max.m_y + CLUSTER_PADDING);
+            clusters.push_back(c);
+        }
+
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "couldn't open out graph file " << path << '\n';
+            return;
+        }
+        out << std::fixed << std::setprecision(1);
+        out << R"(<svg xmlns="http://www.w3.org/2000/svg" width=")" << max_x - min_x << R"(" height=")" << max_y - min_y
+            << R"(" viewBox=")" << min_x << ' ' << min_y << ' ' << max_x - min_x << ' ' << max_y - min_y << R"(">)" << '\n';
+        out << R"(<rect x=")" << min_x << R"(" y=")" << min_y << R"(" width=")" << max_x - min_x << R"(" height=")" << max_y - min_y
+            << R"(" fill=")" << background_color << R"("/>)" << '\n';
+        out << R"(<g font-family="Consolas, monospace" font-size=")" << FONT_SIZE << R"(">)" << '\n';
+
+        for (u32 i = 0; i < clusters.size(); ++i) {
+            const cluster& c = clusters[i];
+            out << R"(<rect x=")" << c.m_min.m_x << R"(" y=")" << c.m_min.m_y << R"(" width=")" << c.m_max.m_x - c.m_min.m_x
+                << R"(" height=")" << c.m_max.m_y - c.m_min.m_y << R"(" fill="none" stroke=")" << loop_upwards_color << R"(" stroke-dasharray="5,2"/>)" << '\n';
+            out << R"(<text x=")" << c.m_min.m_x + CLUSTER_PADDING << R"(" y=")" << c.m_min.m_y + CLUSTER_LABEL_HEIGHT
+                << R"(" fill=")" << accent_color << R"(">cluster_loop_)" << i << "</text>\n";
+        }
+
+        for (u32 i = 0; i < m_edges.size(); ++i) {
+            const std::vector<layout_point>& edge_path = layout.m_edges[i];
+            out << R"(<polyline fill="none" stroke=")" << m_edgeColors[i] << R"(" points=")";
+            for (const auto& point : edge_path) {
+                out << point.m_x << ',' << point.m_y << ' ';
+            }
+            out << R"("/>)" << '\n';
+
+            const layout_point& tip = edge_path.back();
+            const layout_point& prev = edge_path[edge_path.size() - 2];
+            const f32 dx = tip.m_x - prev.m_x;
+            const f32 dy = tip.m_y - prev.m_y;
+            const f32 length = std::max(std::sqrt(dx * dx + dy * dy), 0.001f);
+            const f32 ux = dx / length, uy = dy / length;
+            const f32 base_x = tip.m_x - ux * ARROW_LENGTH, base_y = tip.m_y - uy * ARROW_LENGTH;
+            out << R"(<polygon fill=")" << m_edgeColors[i] << R"(" points=")" << tip.m_x << ',' << tip.m_y << ' '
+                << base_x - uy * ARROW_WIDTH << ',' << base_y + ux * ARROW_WIDTH << ' '
+                << base_x + uy * ARROW_WIDTH << ',' << base_y - ux * ARROW_WIDTH << R"("/>)" << '\n';
         }
-    }
 
-    [[nodiscard]] const control_flow_node& intersect(const node_id node_b1, const node_id node_b2, const std::vector<control_flow_node>& nodes) {
-        const control_flow_node* b1 = &nodes[node_b1];
-        const control_flow_node* b2 = &nodes[node_b2];
-        while (b1->m_index != b2->m_index) {
-            while (b1->m_postorder < b2->m_postorder) {
-                b1 = &nodes[b1->m_ipdom];
+        for (u32 i = 0; i < m_labels.size(); ++i) {
+            const layout_point& pos = layout.m_nodes[i];
+            out << R"(<rect x=")" << pos.m_x << R"(" y=")" << pos.m_y << R"(" width=")" << sizes[i].m_x << R"(" height=")" << sizes[i].m_y
+                << R"(" fill="none" stroke=")" << accent_color << R"("/>)" << '\n';
+            if (i == m_returnNode) {
+                out << R"(<rect x=")" << pos.m_x - 4.f << R"(" y=")" << pos.m_y - 4.f << R"(" width=")" << sizes[i].m_x + 8.f << R"(" height=")" << sizes[i].m_y + 8.f
+                    << R"(" fill="none" stroke=")" << accent_color << R"("/>)" << '\n';
             }
-            while (b2->m_postorder < b1->m_postorder) {
-                b2 = &nodes[b2->m_ipdom];
+            for (u32 line = 0; line < m_labels[i].size(); ++line) {
+                out << R"(<text xml:space="preserve" x=")" << pos.m_x + NODE_PADDING << R"(" y=")" << pos.m_y + NODE_PADDING + line * LINE_HEIGHT + FONT_SIZE
+                    << R"(" fill=")" << accent_color << R"(">)" << html_escape(m_labels[i][line]) << "</text>\n";
             }
         }
-        return *b1;
+        out << "</g>\n</svg>\n";
     }
 
-    void ControlFlowGraph::compute_postdominators() {
+    static void write_dot_cluster(std::ostream& out, const std::vector<control_flow_image::loop>& loops, const node_id loop, const u32 indent) {
+        const std::string pad(indent, ' ');
+        out << pad << "subgraph cluster_loop_" << loop << " {\n";
+        out << pad << "    label=\"cluster_loop_" << loop << "\"; fontcolor=\"" << accent_color << "\"; fontname=\"Consolas\"; color=\"" << loop_upwards_color << "\"; style=\"dashed\";\n";
+        out << pad << "   ";
+        for (const node_id node : loops[loop].m_body) {
+            out << ' ' << node << ';';
+        }
+        out << '\n';
+        // graphviz only draws clusters that are nested in each other, not ones that share nodes
+        for (const node_id child : loops[loop].m_children) {
+            write_dot_cluster(out, loops, child, indent + 4);
+        }
+        out << pad << "}\n";
+    }
 
-        auto order = postorder(m_nodes);
+    // the same graph the svg shows, for rendering with graphviz outside of dconstruct
+    void control_flow_image::write_dot(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "couldn't open out graph file " << path << '\n';
+            return;
+        }
+        out << "digraph G {\n";
+        out << "    bgcolor=\"" << background_color << "\";\n";
+        out << "    splines=\"ortho\";\n";
+        out << "    node [shape=\"plaintext\", fontcolor=\"" << accent_color << "\", color=\"" << accent_color << "\"];\n";
+
+        for (u32 i = 0; i < m_labels.size(); ++i) {
+            out << "    " << i << R"( [label=<<TABLE BORDER="0" CELLBORDER="1" CELLSPACING="0" CELLPADDING="12"><TR><TD ALIGN="LEFT" BALIGN="LEFT"><FONT FACE="Consolas">)";
+            for (const auto& line : m_labels[i]) {
+                out << html_escape(line) << "&#160;&#160;<BR/>";
+            }
+            out << "</FONT></TD></TR></TABLE>>];\n";
+        }
 
-        for (u32 i = 0; i < m_nodes.size(); ++i) {
-            m_nodes[order[i]].m_postorder = i;
+        for (u32 i = 0; i < m_edges.size(); ++i) {
+            out << "    " << m_edges[i].m_from << " -> " << m_edges[i].m_to << " [color=\"" << m_edgeColors[i] << "\"];\n";
         }
-        order.pop_back();
-        std::reverse(order.begin(), order.end());
 
-        const u32 N = order.size();
-        std::unordered_map<node_id, node_id> ipdom;
-        for (auto n : order) {
-            ipdom[n] = control_flow_node::invalid_node;
+        for (node_id i = 0; i < m_loops.size(); ++i) {
+            if (m_loops[i].m_isOutermost) {
+                write_dot_cluster(out, m_loops, i, 4);
+            }
         }
 
-        ipdom[m_nodes.back().m_index] = m_nodes.back().m_index;
-        m_nodes.back().m_ipdom = m_nodes.back().m_index;
+        out << "    subgraph return {\n";
+        out << "        rank=\"max\";\n";
+        out << "        " << m_returnNode << " [peripheries=\"1\"];\n";
+        out << "    }\n";
+        out << "}\n";
+    }
 
-        bool changed = true;
-        while (changed) {
-            changed = false;
-            for (u32 i = 0; i < N; ++i) {
-                node_id n = order[i];
-                node_id new_ipdom = control_flow_node::invalid_node;
-                const control_flow_node& node = m_nodes.at(n);
-                const auto dir_s = node.m_followingNode;
-                const auto tar_s = node.m_targetNode;
-
-                if (dir_s != control_flow_node::invalid_node && ipdom.at(dir_s) != control_flow_node::invalid_node) {
-                    new_ipdom = dir_s;
+    static bool is_back_edge(const control_flow_node& from, const control_flow_node& to) noexcept {
+        return to.m_startLine < from.m_endLine && to.m_index <= from.m_index;
+    }
+
+    // heads are visited from the last node upwards, so inner loops are found before the loops around them.
+    // every finished loop is collapsed into its head, and the outer loop's walk jumps straight to that head.
+    // only nodes the head dominates belong to a loop, so a jump into the middle of a cycle (irreducible) doesn't make one
+    void ControlFlowGraph::find_loops() {
+        const u32 size = m_nodes.size();
+        std::vector<node_id> collapsed_into(size);
+        for (node_id i = 0; i < size; ++i) {
+            collapsed_into[i] = i;
+        }
+        const auto find = [&](node_id n) -> node_id {
+            node_id root = n;
+            while (collapsed_into[root] != root) {
+                root = collapsed_into[root];
+            }
+            while (collapsed_into[n] != root) {
+                n = std::exchange(collapsed_into[n], root);
+            }
+            return root;
+        };
+
+        m_loops.clear();
+        m_loopWithHead.assign(size, control_flow_loop::invalid_loop);
+        std::vector<node_id> visited_by(size, control_flow_loop::invalid_loop);
+        std::vector<node_id> worklist;
+
+        for (node_id head = size; head-- > 0;) {
+            node_id latch = control_flow_node::invalid_node;
+            const node_id loop_idx = m_loops.size();
+            for (const node_id pred : m_nodes[head].m_predecessors) {
+                if (m_nodes[pred].m_targetNode != head || !is_back_edge(m_nodes[pred], m_nodes[head]) || !dominates(head, pred)) {
+                    continue;
                 }
-                else if (tar_s != control_flow_node::invalid_node && ipdom.at(tar_s) != control_flow_node::invalid_node) {
-                    new_ipdom = tar_s;
+                latch = std::min(latch, pred);
+                const node_id member = find(pred);
+                if (member != head && visited_by[member] != loop_idx) {
+                    visited_by[member] = loop_idx;
+                    worklist.push_back(member);
                 }
-                if (new_ipdom == control_flow_node::invalid_node) {
-                    continue;
+            }
+            if (latch == control_flow_node::invalid_node) {
+                continue;
+            }
+
+            control_flow_loop loop;
+            loop.m_headNode = head;
+            loop.m_latchNode = latch;
+            std::vector<node_id> members;
+            while (!worklist.empty()) {
+                const node_id member = worklist.back();
+                worklist.pop_back();
+                members.push_back(member);
+                for (const node_id pred : m_nodes[member].m_predecessors) {
+                    const node_id outer = find(pred);
+                    if (outer <= head || outer == member || visited_by[outer] == loop_idx || !dominates(head, outer)) {
+                        continue;
+                    }
+                    visited_by[outer] = loop_idx;
+                    worklist.push_back(outer);
                 }
+            }
 
-                if (dir_s != control_flow_node::invalid_node && ipdom.at(dir_s) != control_flow_node::invalid_node && dir_s != new_ipdom) {
-                    new_ipdom = intersect(dir_s, new_ipdom, m_nodes).m_index;
+            loop.m_body.push_back(head);
+            for (const node_id member : members) {
+                collapsed_into[member] = head;
+                if (m_loopWithHead[member] != control_flow_loop::invalid_loop) {
+                    auto& inner = m_loops[m_loopWithHead[member]];
+                    inner.m_parent = loop_idx;
+                    loop.m_children.push_back(m_loopWithHead[member]);
+                    loop.m_body.insert(loop.m_body.end(), inner.m_body.begin(), inner.m_body.end());
                 }
-                if (tar_s != control_flow_node::invalid_node && ipdom.at(tar_s) != control_flow_node::invalid_node && tar_s != new_ipdom) {
-                    new_ipdom = intersect(tar_s, new_ipdom, m_nodes).m_index;
+                else {
+                    loop.m_body.push_back(member);
                 }
+            }
+            std::sort(loop.m_body.begin(), loop.m_body.end());
 
-                if (ipdom.at(n) != new_ipdom) {
-                    ipdom[n] = new_ipdom;
-                    m_nodes.at(n).m_ipdom = new_ipdom;
-                    changed = true;
+            for (const node_id member : loop.m_body) {
+                visited_by[member] = loop_idx;
+            }
+            for (const node_id member : loop.m_body) {
+                for (const node_id successor : {m_nodes[member].m_followingNode, m_nodes[member].m_targetNode}) {
+                    if (successor != control_flow_node::invalid_node && visited_by[successor] != loop_idx) {
+                        visited_by[successor] = loop_idx;
+                        loop.m_exits.push_back(successor);
+                    }
                 }
             }
+            std::sort(loop.m_exits.begin(), loop.m_exits.end());
+
+            m_loopWithHead[head] = loop_idx;
+            m_loops.push_back(std::move(loop));
         }
-    }
 
-    [[nodiscard]] std::vector<node_id> ControlFlowGraph::collect_loop_body(const node_id head, const node_id latch) const {
-        std::vector<node_id> body;
-        for (node_id i = head; i < latch; ++i) {
-            body.push_back(i);
+        // outer loops first, in line order
+        const node_id loop_count = m_loops.size();
+        std::reverse(m_loops.begin(), m_loops.end());
+        for (auto& loop : m_loops) {
+            if (loop.m_parent != control_flow_loop::invalid_loop) {
+                loop.m_parent = loop_count - 1 - loop.m_parent;
+            }
+            for (auto& child : loop.m_children) {
+                child = loop_count - 1 - child;
+            }
+            std::sort(loop.m_children.begin(), loop.m_children.end());
+            m_loopWithHead[loop.m_headNode] = loop_count - 1 - m_loopWithHead[loop.m_headNode];
         }
-        return body;
     }
 
-    [[nodiscard]] reg_set ControlFlowGraph::get_read_registers(
-        const control_flow_node& start_node,
-        reg_set check_regs,
-        const node_id stop_node,
-        const istr_line start_line
-    ) const noexcept {
+    [[nodiscard]] bool ControlFlowGraph::is_for_loop(const control_flow_loop& loop) const noexcept {
+        constexpr Opcode standard_for_loop_pattern[] = {
+            Opcode::Move,
+            Opcode::Move,
+            Opcode::ILessThan,
+            Opcode::BranchIfNot,
+        };
+        const auto& head = m_nodes[loop.m_headNode];
+        if (head.m_ipdom != loop.m_latchNode + 1 || head.m_lines.size() < std::size(standard_for_loop_pattern)) {
+            return false;
+        }
+        for (u8 i = 0; i < std::size(standard_for_loop_pattern); ++i) {
+            if (head.m_lines[i].m_instruction.opcode != standard_for_loop_pattern[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
 
-        struct node_reg_pair {
-            const control_flow_node& node;
-            reg_set regs_to_check;
-		};
+    void ControlFlowGraph::find_regions() {
+        m_regions.assign(m_nodes.size(), control_flow_region{});
+        for (const auto& node : m_nodes) {
+            if (node.m_lines.empty()) {
+                continue;
+            }
+            auto& region = m_regions[node.m_index];
+            const Opcode last_opcode = node.m_lines.back().m_instruction.opcode;
 
-		reg_set read;
-        node_set checked(m_nodes.size(), false);
+            if (const auto loop = get_loop_with_head(node.m_index)) {
+                if (is_for_loop(*loop)) {
+                    region.m_kind = region_kind::for_loop;
+                    region.m_follow = node.m_targetNode;
+                } else {
+                    region.m_kind = region_kind::while_loop;
+                    region.m_follow = loop->m_latchNode + 1;
+                }
+            }
+            else if (last_opcode == Opcode::BranchIf || last_opcode == Opcode::BranchIfNot) {
+                // every path through the fallthrough side reaches the target, so the branch only skips a then block
+                region.m_kind = !node.has_following() || postdominates(node.m_targetNode, node.m_followingNode) ? region_kind::if_then : region_kind::if_else;
+                region.m_follow = node.m_ipdom;
+            }
+            else if (node.has_following() && get_loop_with_head(node.m_followingNode)) {
+                region.m_kind = region_kind::loop_entry;
+                region.m_follow = node.m_followingNode;
+            }
+        }
+    }
 
-        std::vector<node_reg_pair> node_stack;
+    struct dominator_tree {
+        // per node, invalid_node for nodes the root doesn't reach
+        std::vector<node_id> m_idom;
+        // preorder/postorder clock of every node in the tree
+        std::vector<node_id> m_enter;
+        std::vector<node_id> m_leave;
+    };
+
+    // semi-NCA (Georgiadis). post-dominators walk the predecessors from the return node, dominators the successors from the entry
+    template <bool post>
+    [[nodiscard]] static dominator_tree compute_dominator_tree(const std::vector<control_flow_node>& nodes, const node_id root) {
+        constexpr node_id unvisited = control_flow_node::invalid_node;
+        const u32 size = nodes.size();
 
-        if (start_line) {
-            const auto [read_first, _x, _y] = start_node.get_register_nature_starting_at(start_line, !m_func.m_isScriptFunction);
-            read |= read_first & check_regs;
-            check_regs &= ~read_first;
-            checked[start_node.m_index] = true;
-            if (start_node.m_followingNode) {
-                node_stack.emplace_back(m_nodes[start_node.m_followingNode], check_regs);
+        const auto for_each_successor = [&nodes](const node_id n, auto&& fn) {
+            for (const node_id successor : {nodes[n].m_followingNode, nodes[n].m_targetNode}) {
+                if (successor != control_flow_node::invalid_node) {
+                    fn(successor);
+                }
             }
-            if (start_node.has_target()) {
-                node_stack.emplace_back(m_nodes[start_node.m_targetNode], check_regs);
+        };
+        const auto for_each_predecessor = [&nodes](const node_id n, auto&& fn) {
+            for (const node_id pred : nodes[n].m_predecessors) {
+                fn(pred);
             }
+        };
+        const auto for_each_forward = [&](const node_id n, auto&& fn) {
+            if constexpr (post) for_each_predecessor(n, fn); else for_each_successor(n, fn);
+        };
+        const auto for_each_backward = [&](const node_id n, auto&& fn) {
+            if constexpr (post) for_each_successor(n, fn); else for_each_predecessor(n, fn);
+        };
+
+        std::vector<node_id> preorder_num(size, unvisited);
+        std::vector<node_id> vertex, parent;
+        vertex.reserve(size);
+        parent.reserve(size);
+
+        std::vector<std::pair<node_id, node_id>> stack;
+        stack.emplace_back(root, 0);
+        while (!stack.empty()) {
+            const auto [n, parent_num] = stack.back();
+            stack.pop_back();
+            if (preorder_num[n] != unvisited) {
+                continue;
+            }
+            preorder_num[n] = vertex.size();
+            vertex.push_back(n);
+            parent.push_back(parent_num);
+            for_each_forward(n, [&](const node_id next) {
+                if (preorder_num[next] == unvisited) {
+                    stack.emplace_back(next, preorder_num[n]);
+                }
+            });
         }
-        else {
-            node_stack.emplace_back(start_node, check_regs);
+
+        const u32 reached = vertex.size();
+        std::vector<node_id> semi(reached), label(reached), ancestor(reached, unvisited), idom(reached);
+        for (node_id i = 0; i < reached; ++i) {
+            semi[i] = label[i] = i;
         }
 
-#ifdef _TRACE  
-        std::cout << "check_regs: " << pretty_regset(check_regs) << '\n';
-#endif
-        while (!node_stack.empty()) {
-            auto [node, local_check_regs] = node_stack.back();
-#ifdef _TRACE
-			std::cout << "processing nature for node " << node.m_index 
-                << " read_first: " << pretty_regset(node.m_regs.m_readFirst) 
-                << " written: " << pretty_regset(node.m_regs.m_written) 
-                << '\n';
-			std::cout << "local check_regs before: " << pretty_regset(local_check_regs) << " read before: " << pretty_regset(read) << '\n';
-#endif
-            node_stack.pop_back();
-            checked[node.m_index] = true;
+        std::vector<node_id> path;
+        const auto eval = [&](const node_id v) -> node_id {
+            if (ancestor[v] == unvisited) {
+                return v;
+            }
+            for (node_id x = v; ancestor[ancestor[x]] != unvisited; x = ancestor[x]) {
+                path.push_back(x);
+            }
+            while (!path.empty()) {
+                const node_id x = path.back();
+                path.pop_back();
+                if (semi[label[ancestor[x]]] < semi[label[x]]) {
+                    label[x] = label[ancestor[x]];
+                }
+                ancestor[x] = ancestor[ancestor[x]];
+            }
+            return label[v];
+        };
 
-            read |= node.m_regs.m_readFirst & local_check_regs;
-            local_check_regs &= ~(node.m_regs.m_readFirst | node.m_regs.m_written);
+        for (node_id w = reached - 1; w > 0; --w) {
+            for_each_backward(vertex[w], [&](const node_id prev) {
+                if (preorder_num[prev] != unvisited) {
+                    semi[w] = std::min(semi[w], semi[eval(preorder_num[prev])]);
+                }
+            });
+            ancestor[w] = parent[w];
+        }
 
-#ifdef _TRACE
-            std::cout << "local check_regs after: " << pretty_regset(local_check_regs) << " read after: " << pretty_regset(read) << '\n';
-#endif
+        idom[0] = 0;
+        for (node_id w = 1; w < reached; ++w) {
+            idom[w] = parent[w];
+            while (idom[w] > semi[w]) {
+                idom[w] = idom[idom[w]];
+            }
+        }
 
-            if (local_check_regs.to_ullong() == 0) {
-                continue;
+        dominator_tree tree{
+            std::vector<node_id>(size, unvisited),
+            std::vector<node_id>(size, unvisited),
+            std::vector<node_id>(size, unvisited)
+        };
+        for (node_id w = 0; w < reached; ++w) {
+            tree.m_idom[vertex[w]] = vertex[idom[w]];
+        }
+
+        std::vector<u32> child_offsets(reached + 1, 0);
+        for (node_id w = 1; w < reached; ++w) {
+            child_offsets[idom[w] + 1]++;
+        }
+        for (u32 i = 1; i <= reached; ++i) {
+            child_offsets[i] += child_offsets[i - 1];
+        }
+        std::vector<node_id> children(reached > 0 ? reached - 1 : 0);
+        std::vector<u32> insert_at(child_offsets.begin(), child_offsets.end() - 1);
+        for (node_id w = 1; w < reached; ++w) {
+            children[insert_at[idom[w]]++] = w;
+        }
+
+        node_id clock = 0;
+        std::vector<std::pair<node_id, u32>> tree_stack;
+        tree_stack.emplace_back(0, child_offsets[0]);
+        tree.m_enter[vertex[0]] = clock++;
+        while (!tree_stack.empty()) {
+            auto& [w, next_child] = tree_stack.back();
+            if (next_child < child_offsets[w + 1]) {
+                const node_id child = children[next_child++];
+                tree.m_enter[vertex[child]] = clock++;
+                tree_stack.emplace_back(child, child_offsets[child]);
             }
+            else {
+                tree.m_leave[vertex[w]] = clock++;
+                tree_stack.pop_back();
+            }
+        }
+        return tree;
+    }
 
-            if (node.has_following() && !checked[node.m_followingNode] && node.m_followingNode != stop_node) {
-                node_stack.emplace_back(m_nodes[node.m_followingNode], local_check_regs);
+    void ControlFlowGraph::compute_postdominators() {
+        const auto order = postorder(m_nodes);
+        for (u32 i = 0; i < order.size(); ++i) {
+            m_nodes[order[i]].m_postorder = i;
+        }
+
+        const dominator_tree tree = compute_dominator_tree<true>(m_nodes, m_nodes.back().m_index);
+        for (auto& node : m_nodes) {
+            if (tree.m_idom[node.m_index] != control_flow_node::invalid_node) {
+                node.m_ipdom = tree.m_idom[node.m_index];
             }
-            if (node.has_target() && !checked[node.m_targetNode] && node.m_targetNode != stop_node) {
-                node_stack.emplace_back(m_nodes[node.m_targetNode], local_check_regs);
+            node.m_pdomEnter = tree.m_enter[node.m_index];
+            node.m_pdomLeave = tree.m_leave[node.m_index];
+        }
+    }
+
+    void ControlFlowGraph::compute_dominators() {
+        const dominator_tree tree = compute_dominator_tree<false>(m_nodes, 0);
+        for (auto& node : m_nodes) {
+            node.m_domEnter = tree.m_enter[node.m_index];
+            node.m_domLeave = tree.m_leave[node.m_index];
+        }
+    }
+
+    [[nodiscard]] bool ControlFlowGraph::dominates(const node_id dominator, const node_id node) const noexcept {
+        const control_flow_node& a = m_nodes[dominator];
+        const control_flow_node& b = m_nodes[node];
+        if (b.m_domEnter == control_flow_node::invalid_node) {
+            return dominator == node;
+        }
+        return a.m_domEnter <= b.m_domEnter && b.m_domLeave <= a.m_domLeave;
+    }
+
+    [[nodiscard]] bool ControlFlowGraph::postdominates(const node_id dominator, const node_id node) const noexcept {
+        const control_flow_node& a = m_nodes[dominator];
+        const control_flow_node& b = m_nodes[node];
+        if (b.m_pdomEnter == control_flow_node::invalid_node) {
+            return dominator == node;
+        }
+        return a.m_pdomEnter <= b.m_pdomEnter && b.m_pdomLeave <= a.m_pdomLeave;
+    }
+
+    [[nodiscard]] node_id ControlFlowGraph::join_readers(const node_id a, const node_id b) noexcept {
+        if (a == b || b == no_reader) {
+            return a;
+        }
+        if (a == no_reader) {
+            return b;
+        }
+        return many_readers;
+    }
+
+    void ControlFlowGraph::compute_liveness() {
+        const node_id return_node = m_nodes.back().m_index;
+        reg_readers nobody;
+        nobody.fill(no_reader);
+
+        m_liveIn.assign(m_nodes.size(), reg_set{});
+        m_liveInBeforeReturn.assign(m_nodes.size(), reg_set{});
+        m_readers.assign(m_nodes.size(), nobody);
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (node_id i = m_nodes.size(); i-- > 0;) {
+                const control_flow_node& node = m_nodes[i];
+                reg_set live_out, live_out_before_return;
+                reg_readers readers;
+                for (reg_idx reg = 0; reg < readers.size(); ++reg) {
+                    readers[reg] = node.m_regs.m_readTwice[reg] ? many_readers : node.m_regs.m_readFirst[reg] ? i : no_reader;
+                }
+
+                for (const node_id successor : {node.m_followingNode, node.m_targetNode}) {
+                    if (successor == control_flow_node::invalid_node) {
+                        continue;
+                    }
+                    live_out |= m_liveIn[successor];
+                    if (successor != return_node) {
+                        live_out_before_return |= m_liveInBeforeReturn[successor];
+                    }
+                    for (reg_idx reg = 0; reg < readers.size(); ++reg) {
+                        if (!node.m_regs.m_written[reg]) {
+                            readers[reg] = join_readers(readers[reg], m_readers[successor][reg]);
+                        }
+                    }
+                }
+
+                const reg_set live_in = node.m_regs.m_readFirst | (live_out & ~node.m_regs.m_written);
+                const reg_set live_in_before_return = node.m_regs.m_readFirst | (live_out_before_return & ~node.m_regs.m_written);
+                if (live_in != m_liveIn[i] || live_in_before_return != m_liveInBeforeReturn[i] || readers != m_readers[i]) {
+                    m_liveIn[i] = live_in;
+                    m_liveInBeforeReturn[i] = live_in_before_return;
+                    m_readers[i] = readers;
+                    changed = true;
+                }
             }
         }
+    }
+
+    [[nodiscard]] reg_set ControlFlowGraph::get_read_registers(
+        const control_flow_node& start_node,
+        const reg_set check_regs,
+        const bool stop_at_return,
+        const istr_line start_line
+    ) const noexcept {
+        const auto& live_in = stop_at_return ? m_liveInBeforeReturn : m_liveIn;
+        if (!start_line) {
+            return live_in[start_node.m_index] & check_regs;
+        }
 
-        return read;
+        const auto [read_first, _x, written] = start_node.get_register_nature_starting_at(start_line, !m_func.m_isScriptFunction);
+        reg_set live_out;
+        if (start_node.has_following()) {
+            live_out |= live_in[start_node.m_followingNode];
+        }
+        if (start_node.has_target()) {
+            live_out |= live_in[start_node.m_targetNode];
+        }
+        return (read_first | (live_out & ~written)) & check_regs;
     }
 
     u8 ControlFlowGraph::get_register_read_count(
@@ -578,12 +945,8 @@ namespace dconstruct {
         const reg_idx reg_to_check,
         const istr_line start_line
     ) const noexcept {
-        node_set checked(m_nodes.size(), false);
-        bool already_read = false;
-        std::vector<std::reference_wrapper<const control_flow_node>> node_stack;
-#ifdef _TRACE
-        std::cout << "check reg " << std::to_string(reg_to_check) << '\n';
-#endif
+        node_id reader = m_readers[start_node.m_index][reg_to_check];
+
         if (start_line) {
             const auto [read_once, read_twice, written] = start_node.get_register_nature_starting_at(start_line, !m_func.m_isScriptFunction);
 #ifdef _TRACE
@@ -593,67 +956,27 @@ namespace dconstruct {
                 << " written: " << pretty_regset(written)
                 << '\n';
 #endif
-
             if (read_twice[reg_to_check]) {
                 return 2;
             }
-
             if (written[reg_to_check]) {
                 return read_once[reg_to_check];
             }
 
-            already_read = read_once[reg_to_check];
-
-            checked[start_node.m_index] = true;
+            // a loop can lead back into the start of this node, which is a different read than the rest of it
+            reader = read_once[reg_to_check] ? start_node_reader : no_reader;
             if (start_node.has_following()) {
-                node_stack.push_back(m_nodes[start_node.m_followingNode]);
+                reader = join_readers(reader, m_readers[start_node.m_followingNode][reg_to_check]);
             }
             if (start_node.has_target()) {
-                node_stack.push_back(m_nodes[start_node.m_targetNode]);
+                reader = join_readers(reader, m_readers[start_node.m_targetNode][reg_to_check]);
             }
         }
-        else {
-            node_stack.push_back(start_node);
-        }
-
-        while (!node_stack.empty()) {
-            const auto& node = node_stack.back().get();
-            node_stack.pop_back();
-#ifdef _TRACE
-            std::cout << "processing read count for node " << node.m_index 
-                << " read_first: " << pretty_regset(node.m_regs.m_readFirst) 
-                << " read_twice: " << pretty_regset(node.m_regs.m_readTwice) 
-                << " written: " << pretty_regset(node.m_regs.m_written) 
-                << " already read " << std::boolalpha << already_read
-				<< '\n';
-#endif
-            checked[node.m_index] = true;
-
-            if (node.m_regs.m_readTwice[reg_to_check] || (node.m_regs.m_readFirst[reg_to_check] && already_read)) {
-#ifdef _TRACE
-				std::cout << "register " << static_cast<u32>(reg_to_check) << " read twice at node " << node.m_index << '\n';
-#endif
-                return 2;
-            }
-            already_read |= node.m_regs.m_readFirst[reg_to_check];
-            if (node.m_regs.m_written[reg_to_check]) {
-                continue;
-            }
 
-            
-#ifdef _TRACE
-            std::cout << "already read after: " << std::boolalpha << already_read << '\n';
-#endif
-
-            if (node.has_following() && !checked[node.m_followingNode]) {
-                node_stack.push_back(m_nodes[node.m_followingNode]);
-            }
-            if (node.has_target() && !checked[node.m_targetNode]) {
-                node_stack.push_back(m_nodes[node.m_targetNode]);
-            }
+        if (reader == no_reader) {
+            return 0;
         }
-
-        return static_cast<u8>(already_read);
+        return reader == many_readers ? 2 : 1;
     }
 
     [[nodiscard]] reg_set ControlFlowGraph::get_registers_written_to(const control_flow_node& start_node, const node_id stop) const {
@@ -692,7 +1015,7 @@ namespace dconstruct {
         const reg_set right = get_registers_written_to(m_nodes[start_node.m_targetNode], ipdom);
 
         const reg_set written = left | right;
-        result = get_read_registers(m_nodes.at(ipdom), written, m_nodes.back().m_index + 1);
+        result = get_read_registers(m_nodes.at(ipdom), written);
 
         return result;
     }
@@ -701,15 +1024,15 @@ namespace dconstruct {
         node_set checked(m_nodes.size(), false);
 
         const reg_set written = get_registers_written_to(m_nodes[last_head_node.m_followingNode], first_head_node.m_index);
-        const reg_set res = get_read_registers(m_nodes[last_head_node.m_targetNode], written, m_nodes.back().m_index);
+        const reg_set res = get_read_registers(m_nodes[last_head_node.m_targetNode], written, true);
 
         return res;
     }
 
     [[nodiscard]] const control_flow_node& ControlFlowGraph::get_final_loop_condition_node(const control_flow_loop& loop, const node_id exit_node) const noexcept {
-        for (u16 i = loop.m_latchNode; i > loop.m_headNode; --i) {
-            if (m_nodes[i].m_targetNode == exit_node) {
-                return m_nodes[i];
+        for (auto it = loop.m_body.rbegin(); it != loop.m_body.rend() && *it != loop.m_headNode; ++it) {
+            if (*it <= loop.m_latchNode && m_nodes[*it].m_targetNode == exit_node) {
+                return m_nodes[*it];
             }
         }
         return m_nodes[loop.m_headNode];
@@ -1,4 +1,5 @@
 #include "decompilation/decomp_function.h"
+#include "ast/optimization/optimization_stats.h"
 #include <sstream>
 #include <iostream>
 #include <iomanip>
@@ -49,7 +50,13 @@ void decomp_function::append_to_current_block(expr_uptr&& expr) {
 const ast::function_definition& decomp_function::decompile(const bool optimization_passes) &
 {
     if (m_graphPath && m_graph.m_nodes.size() > MIN_GRAPH_SIZE) {
-        m_graph.write_image(m_graphPath->string());
+        if (m_graphFormat == graph_format::dot) {
+            m_graph.write_dot(m_graphPath->string());
+        } else if (m_graphFormat == graph_format::svg_async && m_graphQueue != nullptr) {
+            m_graphQueue->push(m_graph.get_image(), *m_graphPath);
+        } else {
+            m_graph.write_image(m_graphPath->string());
+        }
     }
 
     m_functionDefinition.m_name = m_disassembly.m_id;
@@ -69,7 +76,7 @@ const ast::function_definition& decomp_function::decompile(const bool optimizati
         m_functionDefinition.m_parameters.emplace_back(arg_type, "arg_" + std::to_string(i));
     }
 
-    emit_node(m_graph[0], m_graph.m_nodes.back().m_index);
+    emit_sequence(0, m_graph.m_nodes.back().m_index);
     parse_basic_block(m_graph.m_nodes.back());
 
     if (optimization_passes) {
@@ -119,6 +126,18 @@ state_script_functions::state_script_functions(const std::vector<ast::function_d
             event_entry[track_idx].second.push_back(&func);
         }
     }
+
+    if (!m_states.empty() && m_binFile) {
+        assert(m_binFile->m_dcscript != nullptr);
+        ast::code_writer metadata{ 4 * 1024 };
+        metadata << ast::indent_more;
+        emit_script_metadata(metadata);
+        m_scriptMetadata = metadata.take();
+    }
+}
+
+state_script_functions::state_script_functions(const std::vector<ast::function_definition>& funcs, std::string script_metadata) noexcept : state_script_functions(funcs) {
+    m_scriptMetadata = std::move(script_metadata);
 }
 
 [[nodiscard]] void state_script_functions::to_string(std::ostream& os) const noexcept {
@@ -130,11 +149,9 @@ state_script_functions::state_script_functions(const std::vector<ast::function_d
         return;
     }
 
-    assert(m_binFile->m_dcscript != nullptr);
-
     os << "statescript {\n" << ast::indent_more;
 
-    emit_script_metadata(os);
+    os << m_scriptMetadata << std::fixed << std::setprecision(2);
 
     for (const auto& [state_name, blocks] : m_states) {
         os << ast::indent <<  "state " << state_name << " {\n";
@@ -486,7 +503,12 @@ void decomp_function::parse_basic_block(const control_flow_node &node) {
             case Opcode::CastInteger: generated_expression = make_cast<i32>(istr, make_type_from_prim(ast::primitive_kind::I32)); break;
             case Opcode::CastFloat: generated_expression = make_cast<f32>(istr, make_type_from_prim(ast::primitive_kind::F32)); break;
 
-            case Opcode::Move: generated_expression = m_transformableExpressions[istr.operand1]->clone(); break;
+            case Opcode::Move: {
+                if (istr.destination != istr.operand1) {
+                    generated_expression = m_transformableExpressions[istr.operand1]->clone();
+                }
+                break;
+            }
 
             case Opcode::LoadFloat: generated_expression = std::make_unique<ast::dereference_expr>(make_cast<u64>(istr, ast::ptr_type{ ast::primitive_kind::F32 })); break;
             case Opcode::LoadI32: generated_expression = std::make_unique<ast::dereference_expr>(make_cast<u64>(istr, ast::ptr_type{ ast::primitive_kind::I32 })); break;
@@ -537,43 +559,58 @@ void decomp_function::parse_basic_block(const control_flow_node &node) {
 }
 
 
-void decomp_function::emit_node(const control_flow_node& node, const node_id stop_node) {
+void decomp_function::emit_sequence(node_id current, const node_id stop_node) {
+    while (current != stop_node && current != control_flow_node::invalid_node && !m_parsedNodes[current]) {
+        current = emit_node(m_graph[current], stop_node);
+    }
+}
+
+
+[[nodiscard]] node_id decomp_function::emit_node(const control_flow_node& node, const node_id stop_node) {
 #ifdef _TRACE
     std::cout << "emitting node " << std::hex << node.m_startLine << std::dec << " (" << node.m_index << ")" << std::endl;
 #endif
 
-    const node_id current_node_id = node.m_index;
-    if (current_node_id == stop_node || m_parsedNodes[current_node_id]) {
-        return;
-    }
-    m_parsedNodes[current_node_id] = true;
+    m_parsedNodes[node.m_index] = true;
 
-    const auto& last_line = node.m_lines.back();
+    const control_flow_region& region = m_graph.m_regions[node.m_index];
 
-    if (const auto loop = m_graph.get_loop_with_head(node.m_index)) {
-        emit_loop(*loop, stop_node);
-    }
-    else if (last_line.m_instruction.opcode == Opcode::BranchIf || last_line.m_instruction.opcode == Opcode::BranchIfNot) {
-        parse_basic_block(node);
-        if (node.m_ipdom == node.m_targetNode) {
-            emit_if(node, stop_node);
-        } else {
-            emit_if_else(node, stop_node);
+    switch (region.m_kind) {
+        case region_kind::for_loop: {
+            emit_for_loop(*m_graph.get_loop_with_head(node.m_index));
+            break;
         }
-    }
-    else if (const auto loop = m_graph.get_loop_with_head(node.m_followingNode)) {
-        if (node.m_followingNode != stop_node) {
+        case region_kind::while_loop: {
+            emit_while_loop(*m_graph.get_loop_with_head(node.m_index));
+            break;
+        }
+        case region_kind::if_then: {
             parse_basic_block(node);
-            emit_loop(*loop, stop_node);
+            emit_if(node);
+            break;
+        }
+        case region_kind::if_else: {
+            parse_basic_block(node);
+            emit_if_else(node);
+            break;
+        }
+        case region_kind::loop_entry: {
+            if (region.m_follow == stop_node) {
+                return control_flow_node::invalid_node;
+            }
+            parse_basic_block(node);
+            break;
+        }
+        case region_kind::block: {
+            parse_basic_block(node);
+            break;
         }
     }
-    else {
-        parse_basic_block(node);
-    }
+    return region.m_follow;
 }
 
 
-void decomp_function::emit_if(const control_flow_node& node, const node_id stop_node) {
+void decomp_function::emit_if(const control_flow_node& node) {
     const node_id idom = node.m_ipdom;
     m_ipdomsEmitted[idom] = true;
 
@@ -603,33 +640,10 @@ void decomp_function::emit_if(const control_flow_node& node, const node_id stop_
 
     m_transformableExpressions[check_register] = std::move(id);
     append_to_current_block(std::move(declaration));
-
-    emit_node(m_graph[idom], stop_node);
-}
-
-
-[[nodiscard]] bool decomp_function::is_for_loop(const control_flow_loop& loop) const noexcept {
-    constexpr Opcode standard_for_loop_pattern[] = {
-        Opcode::Move,
-        Opcode::Move,
-        Opcode::ILessThan,
-        Opcode::BranchIfNot,
-    };
-    if (m_graph[loop.m_headNode].m_ipdom != loop.m_latchNode + 1) {
-        return false;
-    }
-    const auto& lines = m_graph[loop.m_headNode].m_lines;
-    for (u8 i = 0; i < sizeof(standard_for_loop_pattern); ++i) {
-        if (lines[i].m_instruction.opcode != standard_for_loop_pattern[i]) {
-            return false;
-        }
-    }
-    return true;
 }
 
 
-
-void decomp_function::emit_for_loop(const control_flow_loop& loop, const node_id stop_node) {
+void decomp_function::emit_for_loop(const control_flow_loop& loop) {
     const control_flow_node& head_node = m_graph[loop.m_headNode];
     const node_id loop_entry = head_node.m_followingNode;
     const node_id loop_tail = head_node.m_targetNode;
@@ -665,7 +679,7 @@ void decomp_function::emit_for_loop(const control_flow_loop& loop, const node_id
     }
 
     m_blockStack.push(*loop_block);
-    emit_node(m_graph[loop_entry], head_node.m_index);
+    emit_sequence(loop_entry, head_node.m_index);
     bits = regs_to_emit.to_ullong();
     while (bits != 0) {
         const reg_idx reg = std::countr_zero(bits);
@@ -692,7 +706,6 @@ void decomp_function::emit_for_loop(const control_flow_loop& loop, const node_id
     m_registersToVars[loop_var_reg].pop();
     auto for_loop = std::make_unique<ast::for_stmt>(std::move(declaration), std::move(condition), std::move(increment), std::move(loop_block));
     append_to_current_block(std::move(for_loop));
-    emit_node(m_graph[loop_tail], stop_node);
 }
 
 
@@ -724,7 +737,7 @@ void decomp_function::emit_for_loop(const control_flow_loop& loop, const node_id
 }
 
 
-void decomp_function::emit_while_loop(const control_flow_loop& loop, const node_id stop_node) {
+void decomp_function::emit_while_loop(const control_flow_loop& loop) {
     const node_id loop_tail = m_graph[loop.m_headNode].has_target() ? m_graph[loop.m_headNode].m_targetNode : m_graph[loop.m_headNode].m_followingNode;
     auto loop_block = std::make_unique<ast::block>();
     const node_id head_ipdom = m_graph[loop.m_headNode].m_ipdom;
@@ -776,7 +789,7 @@ void decomp_function::emit_while_loop(const control_flow_loop& loop, const node_
     }
 
     m_blockStack.push(*loop_block);
-    emit_node(loop_entry, loop.m_headNode);
+    emit_sequence(loop_entry.m_index, loop.m_headNode);
     bits = regs_to_emit.to_ullong();
     while (bits != 0) {
         const reg_idx reg = std::countr_zero(bits);
@@ -805,22 +818,10 @@ void decomp_function::emit_while_loop(const control_flow_loop& loop, const node_
 
     auto while_loop = std::make_unique<ast::while_stmt>(std::move(condition), std::move(loop_block));
     append_to_current_block(std::move(while_loop));
-
-    emit_node(m_graph[exit_node], stop_node);
 }
 
 
-void decomp_function::emit_loop(const control_flow_loop &loop, const node_id stop_node) {
-    if (is_for_loop(loop)) {
-        emit_for_loop(loop, stop_node);
-    } else {
-        emit_while_loop(loop, stop_node);
-    }
-}
-
-
-
-void decomp_function::emit_if_else(const control_flow_node &node, node_id stop_node) {
+void decomp_function::emit_if_else(const control_flow_node &node) {
     const node_id idom = node.m_ipdom;
     const bool idom_already_emitted = m_ipdomsEmitted[idom];
     m_ipdomsEmitted[idom] = true;
@@ -869,14 +870,12 @@ void decomp_function::emit_if_else(const control_flow_node &node, node_id stop_n
     stmnt_uptr full_if = std::make_unique<ast::if_stmt>(std::move(condition), std::move(then_block), std::move(_else));
 
     append_to_current_block(std::move(full_if));
-
-    emit_node(m_graph[idom], stop_node);
 }
 
 
 void decomp_function::emit_branch(ast::block &else_block, const node_id target, const node_id idom, reg_set regs_to_emit, std::unordered_map<reg_idx, ast::full_type> &regs_to_type) {
     m_blockStack.push(else_block);
-    emit_node(m_graph[target], idom);
+    emit_sequence(target, idom);
     auto bits = regs_to_emit.to_ullong();
     while (bits != 0) {
         const reg_idx reg = std::countr_zero(bits);
@@ -967,7 +966,7 @@ template<typename to>
     const ast::literal* old_lit = m_transformableExpressions[istr.destination]->as_literal();
     if (!old_lit) {
         const auto& op2 = m_transformableExpressions[istr.destination];
-        return op2->new_cast(type, *op2->get_grouped());
+        return op2->new_cast(type, *op2);
     }
     else {
         return std::visit([&type, &old_lit](auto&& arg) -> expr_uptr {
@@ -1169,7 +1168,7 @@ template<typename to>
 
 
 void decomp_function::insert_return(const reg_idx dest) {
-    *m_functionDefinition.m_type.m_return = m_transformableExpressions[dest]->get_type_unchecked(m_env);
+    m_functionDefinition.m_type.m_return = ast::intern_type(m_transformableExpressions[dest]->get_type_unchecked(m_env));
     append_to_current_block(std::make_unique<ast::return_stmt>(std::move(m_transformableExpressions[dest])));
 }
 
@@ -1185,13 +1184,34 @@ template<ast::primitive_kind kind>
 
 
 void decomp_function::optimize_ast() {
-    ast::var_optimization_env var_base{};
-    m_functionDefinition.m_body.var_optimization_pass(var_base);
-    ast::foreach_optimization_env foreach_base{};
-    m_functionDefinition.m_body.foreach_optimization_pass(foreach_base);
-    ast::match_optimization_env match_base{};
-    m_functionDefinition.m_body.match_optimization_pass(match_base);
-    ast::var_optimization_env var_base1{};
-    m_functionDefinition.m_body.var_optimization_pass(var_base1);
+    auto& stats = ast::g_optimizationStats;
+    auto& body = m_functionDefinition.m_body;
+
+    bool changed = stats.time_pass(ast::OPTIMIZATION_PASS::VAR, [&body] {
+        ast::var_optimization_env var_base{};
+        body.var_optimization_pass(var_base);
+        return var_base.m_changed;
+    });
+    changed |= stats.time_pass(ast::OPTIMIZATION_PASS::FOREACH, [&body] {
+        ast::foreach_optimization_env foreach_base{};
+        body.foreach_optimization_pass(foreach_base);
+        return foreach_base.m_changed;
+    });
+    changed |= stats.time_pass(ast::OPTIMIZATION_PASS::MATCH, [&body] {
+        ast::match_optimization_env match_base{};
+        body.match_optimization_pass(match_base);
+        return match_base.m_changed;
+    });
+
+    // the passes only rewrite, so on an unchanged tree the second var pass would find nothing new
+    if (!changed) {
+        stats.skip_pass(ast::OPTIMIZATION_PASS::VAR_CLEANUP);
+        return;
+    }
+    stats.time_pass(ast::OPTIMIZATION_PASS::VAR_CLEANUP, [&body] {
+        ast::var_optimization_env var_base{};
+        body.var_optimization_pass(var_base);
+        return var_base.m_changed;
+    });
 }
 }
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "decompilation/function_memo.h"
+#include "ast/serialization.h"
+#include <cstring>
+#include <mutex>
+
+namespace dconstruct::dcompiler {
+
+    [[nodiscard]] static bool reads_symbol_table(const Opcode opcode) noexcept {
+        switch (opcode) {
+            case Opcode::LoadStaticI8Imm:
+            case Opcode::LoadStaticU8Imm:
+            case Opcode::LoadStaticI16Imm:
+            case Opcode::LoadStaticU16Imm:
+            case Opcode::LoadStaticI32Imm:
+            case Opcode::LoadStaticU32Imm:
+            case Opcode::LoadStaticI64Imm:
+            case Opcode::LoadStaticU64Imm:
+            case Opcode::LoadStaticFloatImm:
+            case Opcode::LoadStaticPointerImm:
+            case Opcode::LookupPointer: return true;
+            default: return false;
+        }
+    }
+
+
+    [[nodiscard]] function_memo::key function_memo::get_key(const function_disassembly& func, const BinaryFile& file, const bool optimize) {
+        ast::ast_writer content;
+        content.write(optimize);
+        content.write(func.m_isScriptFunction);
+        content.write(func.m_stackFrame.m_registerArgs);
+        content.write(func.m_stackFrame.m_labels);
+
+        const SymbolTable& symbol_table = func.m_stackFrame.m_symbolTable;
+        content.write(static_cast<u32>(func.m_lines.size()));
+        for (const auto& line : func.m_lines) {
+            const Instruction& istr = line.m_instruction;
+            content.write(istr.opcode);
+            content.write(istr.destination);
+            content.write(istr.operand1);
+            content.write(istr.operand2);
+            content.write(line.m_target);
+            if (!reads_symbol_table(istr.opcode)) {
+                continue;
+            }
+            // pointers differ between files, strings are compared by their contents. every other entry is a number or a sid.
+            const u64 value = symbol_table.get<u64>(istr.operand1);
+            if (istr.opcode == Opcode::LoadStaticPointerImm) {
+                const bool is_string = value >= reinterpret_cast<u64>(file.m_strings.m_ptr);
+                content.write(is_string);
+                if (is_string) {
+                    content.write(std::string{ symbol_table.get<const char*>(istr.operand1) });
+                }
+            } else {
+                content.write(value);
+            }
+            if (istr.operand1 < symbol_table.m_types.size()) {
+                content.write(symbol_table.m_types[istr.operand1]);
+            }
+        }
+
+        u64 hash = 0xCBF29CE484222325;
+        for (const std::byte b : content.data()) {
+            hash ^= static_cast<u8>(b);
+            hash *= 0x100000001B3;
+        }
+        return key{ hash, content.data() };
+    }
+
+
+    [[nodiscard]] std::optional<std::expected<ast::function_definition, std::string>> function_memo::find(const key& key, const function_name_variant& name) {
+        ++m_lookups;
+        const entry* found = nullptr;
+        {
+            std::shared_lock lock(m_mutex);
+            const auto [begin, end] = m_entries.equal_range(key.m_hash);
+            for (auto it = begin; it != end; ++it) {
+                if (it->second.m_content == key.m_content) {
+                    // entries are never changed or removed once inserted, so they can be read without the lock
+                    found = &it->second;
+                    break;
+                }
+            }
+        }
+        if (found == nullptr) {
+            return std::nullopt;
+        }
+        ++m_hits;
+        if (!found->m_error.empty()) {
+            return std::unexpected{ found->m_error };
+        }
+
+        ast::function_definition res;
+        res.m_name = name;
+        res.m_parameters = found->m_function.m_parameters;
+        res.m_type = found->m_function.m_type;
+        for (const auto& statement : found->m_function.m_body.m_statements) {
+            res.m_body.m_statements.push_back(statement->clone());
+        }
+        return res;
+    }
+
+
+    void function_memo::insert(const key& key, const ast::function_definition& func) {
+        entry copy;
+        copy.m_content = key.m_content;
+        copy.m_function.m_name = func.m_name;
+        copy.m_function.m_parameters = func.m_parameters;
+        copy.m_function.m_type = func.m_type;
+        {
+            const ast::node_arena::scope heap_scope{ nullptr };
+            for (const auto& statement : func.m_body.m_statements) {
+                copy.m_function.m_body.m_statements.push_back(statement->clone());
+            }
+        }
+        insert_entry(key.m_hash, std::move(copy));
+    }
+
+
+    void function_memo::insert_error(const key& key, std::string error) {
+        entry failed;
+        failed.m_content = key.m_content;
+        failed.m_error = std::move(error);
+        insert_entry(key.m_hash, std::move(failed));
+    }
+
+
+    void function_memo::insert_entry(const u64 hash, entry&& new_entry) {
+        std::unique_lock lock(m_mutex);
+        const auto [begin, end] = m_entries.equal_range(hash);
+        for (auto it = begin; it != end; ++it) {
+            if (it->second.m_content == new_entry.m_content) {
+                return;
+            }
+        }
+        m_entries.emplace(hash, std::move(new_entry));
+    }
+
+
+    void function_memo::print_stats(std::ostream& os) const {
+        const u64 lookups = m_lookups;
+        const u64 hits = m_hits;
+        u64 unique = 0;
+        {
+            std::shared_lock lock(m_mutex);
+            unique = m_entries.size();
+        }
+        os << "function memo: " << hits << " of " << lookups << " functions were copies (" << (lookups ? hits * 100 / lookups : 0)
+           << "%), " << unique << " unique functions decompiled\n";
+    }
+}
@@ -0,0 +1,306 @@
+#include "decompilation/graph_layout.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace dconstruct {
+
+    static constexpr f32 MARGIN = 24.f;
+    static constexpr f32 NODE_SPACING = 32.f;
+    static constexpr f32 DUMMY_SPACING = 12.f;
+    static constexpr f32 LAYER_SPACING = 56.f;
+    static constexpr f32 BACK_EDGE_SPACING = 20.f;
+    static constexpr f32 SELF_LOOP_HEIGHT = 16.f;
+    static constexpr u32 ORDER_SWEEPS = 12;
+    static constexpr u32 PLACEMENT_SWEEPS = 8;
+
+    // a node of the graph, or a dummy that an edge passes through
+    struct layout_vertex {
+        std::vector<u32> m_up;
+        std::vector<u32> m_down;
+        f32 m_width = 0.f;
+        f32 m_height = 0.f;
+        f32 m_x = 0.f;
+        u32 m_layer = 0;
+        u32 m_order = 0;
+    };
+
+
+    [[nodiscard]] static u64 count_crossings(const std::vector<layout_vertex>& vertices, const std::vector<u32>& upper_layer) {
+        std::vector<std::pair<u32, u32>> segments;
+        for (const u32 v : upper_layer) {
+            for (const u32 down : vertices[v].m_down) {
+                segments.emplace_back(vertices[v].m_order, vertices[down].m_order);
+            }
+        }
+        std::sort(segments.begin(), segments.end());
+        u64 crossings = 0;
+        for (u32 i = 0; i < segments.size(); ++i) {
+            for (u32 j = i + 1; j < segments.size(); ++j) {
+                crossings += segments[i].first != segments[j].first && segments[i].second > segments[j].second;
+            }
+        }
+        return crossings;
+    }
+
+
+    // moves the vertices of a layer as close to the desired centers as possible without changing their order or letting them overlap.
+    // this is an isotonic regression on the desired centers minus the room the vertices to the left need, solved by pooling adjacent violators
+    static void place_layer(std::vector<layout_vertex>& vertices, const std::vector<u32>& layer, const std::vector<f32>& desired, const u32 num_nodes) {
+        std::vector<f32> offsets(layer.size(), 0.f);
+        for (u32 i = 1; i < layer.size(); ++i) {
+            const bool dummy = layer[i - 1] >= num_nodes || layer[i] >= num_nodes;
+            offsets[i] = offsets[i - 1] + (vertices[layer[i - 1]].m_width + vertices[layer[i]].m_width) / 2.f + (dummy ? DUMMY_SPACING : NODE_SPACING);
+        }
+
+        struct block {
+            f32 m_sum;
+            u32 m_count;
+        };
+        std::vector<block> blocks;
+        for (u32 i = 0; i < layer.size(); ++i) {
+            blocks.push_back({ desired[i] - offsets[i], 1 });
+            while (blocks.size() >= 2) {
+                const block& last = blocks.back();
+                const block& prev = blocks[blocks.size() - 2];
+                if (prev.m_sum / prev.m_count <= last.m_sum / last.m_count) {
+                    break;
+                }
+                const block merged{ prev.m_sum + last.m_sum, prev.m_count + last.m_count };
+                blocks.pop_back();
+                blocks.back() = merged;
+            }
+        }
+
+        u32 i = 0;
+        for (const block& b : blocks) {
+            const f32 position = b.m_sum / b.m_count;
+            for (u32 j = 0; j < b.m_count; ++j, ++i) {
+                vertices[layer[i]].m_x = position + offsets[i];
+            }
+        }
+    }
+
+
+    [[nodiscard]] graph_layout layout_layered(std::span<const layout_point> node_sizes, std::span<const layout_edge> edges, const node_id last_node) {
+        graph_layout res;
+        const u32 num_nodes = node_sizes.size();
+        if (num_nodes == 0) {
+            return res;
+        }
+
+        std::vector<layout_vertex> vertices(num_nodes);
+        std::vector<std::vector<u32>> upper_neighbours(num_nodes);
+        for (u32 i = 0; i < num_nodes; ++i) {
+            vertices[i].m_width = node_sizes[i].m_x;
+            vertices[i].m_height = node_sizes[i].m_y;
+        }
+        // nodes are in program order, so every edge that goes to an earlier node closes a loop and is turned around for the layering
+        for (const auto& edge : edges) {
+            const u32 upper = std::min(edge.m_from, edge.m_to);
+            const u32 lower = std::max(edge.m_from, edge.m_to);
+            if (upper != lower) {
+                upper_neighbours[lower].push_back(upper);
+            }
+        }
+
+        u32 num_layers = 1;
+        const auto assign_layers = [&](const u32 first) {
+            for (u32 i = first; i < num_nodes; ++i) {
+                vertices[i].m_layer = 0;
+                for (const u32 upper : upper_neighbours[i]) {
+                    vertices[i].m_layer = std::max(vertices[i].m_layer, vertices[upper].m_layer + 1);
+                }
+                num_layers = std::max(num_layers, vertices[i].m_layer + 1);
+            }
+        };
+        assign_layers(0);
+        // the last node goes to the bottom. the nodes behind it in program order are layered again, so the ones connected to it
+        // stay below it and every edge keeps going down from its upper to its lower end
+        if (last_node < num_nodes) {
+            vertices[last_node].m_layer = num_layers - 1;
+            assign_layers(last_node + 1);
+        }
+
+        // the vertices every edge passes through from its upper to its lower end
+        std::vector<std::vector<u32>> chains(edges.size());
+        for (u32 e = 0; e < edges.size(); ++e) {
+            const u32 upper = std::min(edges[e].m_from, edges[e].m_to);
+            const u32 lower = std::max(edges[e].m_from, edges[e].m_to);
+            if (upper == lower) {
+                continue;
+            }
+            std::vector<u32>& chain = chains[e];
+            chain.push_back(upper);
+            for (u32 layer = vertices[upper].m_layer + 1; layer < vertices[lower].m_layer; ++layer) {
+                layout_vertex dummy;
+                dummy.m_layer = layer;
+                chain.push_back(vertices.size());
+                vertices.push_back(std::move(dummy));
+            }
+            chain.push_back(lower);
+            for (u32 i = 1; i < chain.size(); ++i) {
+                vertices[chain[i - 1]].m_down.push_back(chain[i]);
+                vertices[chain[i]].m_up.push_back(chain[i - 1]);
+            }
+        }
+
+        std::vector<std::vector<u32>> layers(num_layers);
+        for (u32 v = 0; v < vertices.size(); ++v) {
+            vertices[v].m_order = layers[vertices[v].m_layer].size();
+            layers[vertices[v].m_layer].push_back(v);
+        }
+
+        const auto total_crossings = [&]() {
+            u64 crossings = 0;
+            for (u32 l = 0; l + 1 < num_layers; ++l) {
+                crossings += count_crossings(vertices, layers[l]);
+            }
+            return crossings;
+        };
+
+        // barycenter sweeps, alternating downwards and upwards. the best order seen is kept
+        std::vector<std::vector<u32>> best_layers = layers;
+        u64 best_crossings = total_crossings();
+        std::vector<f32> barycenter(vertices.size());
+        for (u32 sweep = 0; sweep < ORDER_SWEEPS && best_crossings != 0; ++sweep) {
+            const bool downwards = sweep % 2 == 0;
+            for (u32 step = 1; step < num_layers; ++step) {
+                std::vector<u32>& layer = layers[downwards ? step : num_layers - 1 - step];
+                for (const u32 v : layer) {
+                    const std::vector<u32>& neighbours = downwards ? vertices[v].m_up : vertices[v].m_down;
+                    if (neighbours.empty()) {
+                        barycenter[v] = static_cast<f32>(vertices[v].m_order);
+                        continue;
+                    }
+                    f32 sum = 0.f;
+                    for (const u32 n : neighbours) {
+                        sum += static_cast<f32>(vertices[n].m_order);
+                    }
+                    barycenter[v] = sum / neighbours.size();
+                }
+                std::stable_sort(layer.begin(), layer.end(), [&](const u32 a, const u32 b) { return barycenter[a] < barycenter[b]; });
+                for (u32 i = 0; i < layer.size(); ++i) {
+                    vertices[layer[i]].m_order = i;
+                }
+            }
+            const u64 crossings = total_crossings();
+            if (crossings < best_crossings) {
+                best_crossings = crossings;
+                best_layers = layers;
+            }
+        }
+        layers = std::move(best_layers);
+        for (const auto& layer : layers) {
+            for (u32 i = 0; i < layer.size(); ++i) {
+                vertices[layer[i]].m_order = i;
+            }
+        }
+
+        // start with every layer packed to the left, then pull the vertices towards their neighbours
+        std::vector<f32> desired;
+        for (const auto& layer : layers) {
+            desired.assign(layer.size(), 0.f);
+            place_layer(vertices, layer, desired, num_nodes);
+        }
+        for (u32 sweep = 0; sweep < PLACEMENT_SWEEPS; ++sweep) {
+            const bool last_sweep = sweep + 1 == PLACEMENT_SWEEPS;
+            const bool downwards = sweep % 2 == 0;
+            for (u32 step = 0; step < num_layers; ++step) {
+                const std::vector<u32>& layer = layers[downwards ? step : num_layers - 1 - step];
+                desired.resize(layer.size());
+                for (u32 i = 0; i < layer.size(); ++i) {
+                    const layout_vertex& vertex = vertices[layer[i]];
+                    f32 sum = 0.f;
+                    u32 count = 0;
+                    if (downwards || last_sweep) {
+                        for (const u32 n : vertex.m_up) {
+                            sum += vertices[n].m_x;
+                            ++count;
+                        }
+                    }
+                    if (!downwards || last_sweep) {
+                        for (const u32 n : vertex.m_down) {
+                            sum += vertices[n].m_x;
+                            ++count;
+                        }
+                    }
+                    desired[i] = count != 0 ? sum / count : vertex.m_x;
+                }
+                place_layer(vertices, layer, desired, num_nodes);
+            }
+        }
+
+        f32 min_left = std::numeric_limits<f32>::max();
+        for (const auto& vertex : vertices) {
+            min_left = std::min(min_left, vertex.m_x - vertex.m_width / 2.f);
+        }
+        for (auto& vertex : vertices) {
+            vertex.m_x += MARGIN - min_left;
+        }
+
+        std::vector<f32> layer_top(num_layers);
+        std::vector<f32> layer_height(num_layers, 0.f);
+        for (const auto& vertex : vertices) {
+            layer_height[vertex.m_layer] = std::max(layer_height[vertex.m_layer], vertex.m_height);
+        }
+        f32 y = MARGIN;
+        for (u32 l = 0; l < num_layers; ++l) {
+            layer_top[l] = y;
+            y += layer_height[l] + LAYER_SPACING;
+        }
+        res.m_height = y - LAYER_SPACING + MARGIN;
+
+        const auto top = [&](const u32 v) { return layer_top[vertices[v].m_layer] + (layer_height[vertices[v].m_layer] - vertices[v].m_height) / 2.f; };
+        const auto center_y = [&](const u32 v) { return layer_top[vertices[v].m_layer] + layer_height[vertices[v].m_layer] / 2.f; };
+        const auto right = [&](const u32 v) { return vertices[v].m_x + vertices[v].m_width / 2.f; };
+
+        res.m_nodes.reserve(num_nodes);
+        for (u32 i = 0; i < num_nodes; ++i) {
+            res.m_nodes.push_back({ vertices[i].m_x - vertices[i].m_width / 2.f, top(i) });
+            res.m_width = std::max(res.m_width, right(i));
+        }
+
+        res.m_edges.resize(edges.size());
+        for (u32 e = 0; e < edges.size(); ++e) {
+            const u32 from = edges[e].m_from;
+            const u32 to = edges[e].m_to;
+            std::vector<layout_point>& path = res.m_edges[e];
+            if (from == to) {
+                const f32 x = right(from);
+                const f32 y_center = center_y(from);
+                path = { { x, y_center - SELF_LOOP_HEIGHT / 2.f }, { x + BACK_EDGE_SPACING, y_center - SELF_LOOP_HEIGHT / 2.f },
+                         { x + BACK_EDGE_SPACING, y_center + SELF_LOOP_HEIGHT / 2.f }, { x, y_center + SELF_LOOP_HEIGHT / 2.f } };
+            } else if (from < to) {
+                const std::vector<u32>& chain = chains[e];
+                path.push_back({ vertices[from].m_x, top(from) + vertices[from].m_height });
+                for (u32 i = 1; i + 1 < chain.size(); ++i) {
+                    const u32 layer = vertices[chain[i]].m_layer;
+                    path.push_back({ vertices[chain[i]].m_x, layer_top[layer] });
+                    path.push_back({ vertices[chain[i]].m_x, layer_top[layer] + layer_height[layer] });
+                }
+                path.push_back({ vertices[to].m_x, top(to) });
+            } else {
+                // edges going up leave and enter the nodes on their right side
+                const std::vector<u32>& chain = chains[e];
+                path.push_back({ right(from), center_y(from) });
+                if (chain.size() == 2) {
+                    const f32 x = std::max(right(from), right(to)) + BACK_EDGE_SPACING;
+                    path.push_back({ x, center_y(from) });
+                    path.push_back({ x, center_y(to) });
+                }
+                for (u32 i = chain.size() - 2; i > 0; --i) {
+                    const u32 layer = vertices[chain[i]].m_layer;
+                    path.push_back({ vertices[chain[i]].m_x, layer_top[layer] + layer_height[layer] });
+                    path.push_back({ vertices[chain[i]].m_x, layer_top[layer] });
+                }
+                path.push_back({ right(to), center_y(to) });
+            }
+            for (const auto& point : path) {
+                res.m_width = std::max(res.m_width, point.m_x);
+            }
+        }
+        res.m_width += MARGIN;
+        return res;
+    }
+}
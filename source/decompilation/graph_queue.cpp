@@ -0,0 +1,29 @@
+#include "decompilation/graph_queue.h"
+#include <algorithm>
+#include <execution>
+
+namespace dconstruct {
+
+    void graph_queue::push(control_flow_image image, std::filesystem::path path) {
+        std::lock_guard lock(m_mutex);
+        m_jobs.push_back({ std::move(image), std::move(path) });
+    }
+
+
+    std::size_t graph_queue::render_all() {
+        std::vector<job> jobs;
+        {
+            std::lock_guard lock(m_mutex);
+            jobs.swap(m_jobs);
+        }
+        std::for_each(
+            std::execution::par_unseq,
+            jobs.begin(),
+            jobs.end(),
+            [](const job& job) {
+                job.m_image.write_svg(job.m_path.string());
+            }
+        );
+        return jobs.size();
+    }
+}
@@ -124,10 +124,18 @@ u8 Disassembler::insert_struct_or_arraylike(const location struct_location, cons
             bytes_inserted = 8;
             return bytes_inserted;
         }
+        // targets the struct table doesn't know about still get their type ID from the header in front of them
+        const struct_table_entry* pointee = m_currentFile->get_struct(location().from(struct_location));
         const location next_struct_header = location().from(struct_location, -8);
-        if (!next_struct_header.is_aligned() || !is_unmapped_sid(next_struct_header)) {
+        sid64 type_id = 0;
+        if (pointee != nullptr) {
+            type_id = pointee->m_typeId;
+        } else if (next_struct_header.is_aligned() && is_unmapped_sid(next_struct_header)) {
+            type_id = next_struct_header.get<sid64>();
+        }
+        if (type_id == 0) {
             insert_anonymous_array(struct_location, indent);
-        } else if (next_struct_header.get<sid64>() == SID("array")) {
+        } else if (get_struct_kind(type_id) == struct_kind::ARRAY) {
             insert_array(struct_location, get_size_array(struct_location, indent), indent);
         } else {
             insert_struct(next_struct_header.as<structs::unmapped>(), indent);
@@ -194,16 +202,31 @@ void Disassembler::insert_array(const location array, const u32 array_size, cons
     u32 member_count = 0;
     const location member = location().from(array);
 
-    while (!m_currentFile->is_string(member + member_offset) && !m_currentFile->gets_pointed_at(member + member_offset)) {
-        member_offset += 8;
+    u32 array_bytes;
+    if (const struct_table_entry* entry = m_currentFile->get_struct(member)) {
+        array_bytes = m_currentFile->get_array_size(*entry);
+    } else {
+        while (!m_currentFile->is_string(member + member_offset) && !m_currentFile->gets_pointed_at(member + member_offset)) {
+            member_offset += 8;
+        }
+        const u8 type_id_padding = m_currentFile->is_string(member + member_offset) ? 0 : 8;
+        array_bytes = member_offset - type_id_padding;
     }
+    u32 struct_size = array_bytes / array_size;
 
-    const u8 type_id_padding = m_currentFile->is_string(member + member_offset) ? 0 : 8;
-    u32 struct_size = (member_offset - type_id_padding) / array_size;
+    if (m_options.m_emitOnce && array_bytes >= MIN_DEDUP_SIZE) {
+        if (const auto emitted_offset = m_currentFile->find_emitted_content(member, array_bytes, array_size)) {
+            // the array's data starts with its first struct, so this is the address that struct is printed with
+            insert_span_indent("%*sALREADY EMITTED AS [0x%05X]\n", indent + m_options.m_indentPerLevel, *emitted_offset);
+            insert_span("}\n", indent);
+            return;
+        }
+        m_currentFile->add_emitted_content(member, array_bytes, array_size);
+    }
 
     for (u32 array_entry_count = 0; array_entry_count < array_size; ++array_entry_count) {
         member_offset = member_count = 0;
-        insert_span_indent("%*s[%u] anonymous struct [0x%x] {\n", 
+        insert_span_indent("%*s[%u] anonymous struct [0x%05X] {\n", 
             indent + m_options.m_indentPerLevel, 
             array_entry_count,
             get_offset(member + array_entry_count * struct_size)
@@ -228,55 +251,143 @@ void Disassembler::insert_unmapped_struct(const structs::unmapped *struct_ptr, c
     u64 last_member_size = 0;
     u32 member_count = 0;
     const location member_start = location(&struct_ptr->m_data);
+    const struct_table_entry* entry = m_currentFile->get_struct(member_start);
     location member_location = member_start;
+
+    StructLayoutCache* layout_cache = entry != nullptr ? m_options.m_layoutCache : nullptr;
+    if (layout_cache != nullptr) {
+        if (const auto* layout = layout_cache->get_confirmed(struct_ptr->typeID)) {
+            if (insert_struct_from_layout(struct_ptr, *entry, *layout, indent)) {
+                return;
+            }
+        }
+    }
+
+    std::vector<member_kind> members;
     while (!offset_gets_pointed_at) {
         member_offset += last_member_size;
         insert_span_indent("%*s[%d] ", indent, member_count++);
-        last_member_size = insert_next_struct_member(member_start + member_offset, indent);
+        const char* sid_name = nullptr;
+        const member_kind kind = get_member_kind(member_start + member_offset, &sid_name);
+        if (layout_cache != nullptr) {
+            members.push_back(kind);
+        }
+        last_member_size = insert_struct_member(member_start + member_offset, kind, indent, sid_name);
         member_location = member_start + (member_offset + last_member_size);
-        offset_gets_pointed_at = m_currentFile->gets_pointed_at(member_location + 8) || m_currentFile->is_string(member_location);
+        if (entry != nullptr) {
+            offset_gets_pointed_at = member_offset + last_member_size >= entry->m_size;
+        } else {
+            offset_gets_pointed_at = m_currentFile->gets_pointed_at(member_location + 8) || m_currentFile->is_string(member_location);
+        }
+    }
+    if (layout_cache != nullptr) {
+        layout_cache->add_sighting(struct_ptr->typeID, members);
     }
 }
 
 
+[[nodiscard]] bool Disassembler::insert_struct_from_layout(const structs::unmapped *struct_ptr, const struct_table_entry& entry, const std::vector<member_kind>& layout, const u32 indent) {
+    const location member_start = location(&struct_ptr->m_data);
+
+    // the layout must end exactly where the regular member walk would and agree with the reloc table on every pointer,
+    // otherwise this instance is decoded from scratch
+    bool fits = !layout.empty();
+    u64 member_offset = 0;
+    for (u64 i = 0; i < layout.size() && fits; ++i) {
+        const bool is_ptr = m_currentFile->is_file_ptr(member_start + member_offset);
+        member_offset += get_member_kind_size(layout[i]);
+        const bool is_last = i + 1 == layout.size();
+        fits = (is_ptr == (layout[i] == member_kind::POINTER)) && (is_last == (member_offset >= entry.m_size));
+    }
+    if (!fits) {
+        m_options.m_layoutCache->m_contradictions++;
+        if (m_options.m_validateLayouts) {
+            insert_span_indent("%*s(cached layout of %s doesn't match this instance)\n", indent, lookup(struct_ptr->typeID));
+        }
+        return false;
+    }
+
+    member_offset = 0;
+    for (u64 i = 0; i < layout.size(); ++i) {
+        const location member = member_start + member_offset;
+        insert_span_indent("%*s[%d] ", indent, static_cast<u32>(i));
+        member_offset += insert_struct_member(member, layout[i], indent);
+        if (m_options.m_validateLayouts) {
+            const member_kind inferred = get_member_kind(member);
+            if (inferred != layout[i]) {
+                m_options.m_layoutCache->m_contradictions++;
+                insert_span_indent("%*s(cached as %s, but looks like %s)\n", indent, get_member_kind_name(layout[i]), get_member_kind_name(inferred));
+            }
+        }
+    }
+    m_options.m_layoutCache->m_cachedInstances++;
+    return true;
+}
+
+
 u8 Disassembler::insert_next_struct_member(const location member, const u32 indent) {
-    u8 member_size;
-    const char *str_ptr = nullptr;
+    const char* sid_name = nullptr;
+    const member_kind kind = get_member_kind(member, &sid_name);
+    return insert_struct_member(member, kind, indent, sid_name);
+}
+
+
+[[nodiscard]] member_kind Disassembler::get_member_kind(const location member, const char** sid_name) const noexcept {
+    const char* str_ptr = nullptr;
     if (m_currentFile->is_file_ptr(member)) {
-        if (member >= m_currentFile->m_strings) {
-            insert_span_fmt("string: \"%s\"\n", member.as<char>());
-        }
-        else {
-            insert_struct_or_arraylike(member, indent);
-        }
-        member_size = 8;
+        return member_kind::POINTER;
     }
     else if ((str_ptr = m_sidbase->search(member.get<sid64>())) != nullptr) {
-        insert_span_fmt("sid: %s\n", str_ptr);
-        member_size = 8;
+        if (sid_name != nullptr) {
+            *sid_name = str_ptr;
+        }
+        return member_kind::SID;
     }
     else if (is_possible_float(member.as<f32>())) {
-        insert_span_fmt("float: %.2f\n", member.get<f32>());
-        member_size = 4;
+        return member_kind::FLOAT;
     }
     else if (is_possible_i32(member.as<i32>())) {
-        insert_span_fmt("int: %d\n", member.get<i32>());
-        member_size = 4;
+        return member_kind::I32;
     }
     else if (is_unmapped_sid(member)) {
-        str_ptr = lookup(member.get<sid64>());
-        insert_span_fmt("sid: %s\n", str_ptr);
-        member_size = 8;
+        return member_kind::UNMAPPED_SID;
     }
-    else {
-        insert_span_fmt("int: %d\n", member.get<i32>());
-        member_size = 4;
+    return member_kind::INT;
+}
+
+
+u8 Disassembler::insert_struct_member(const location member, const member_kind kind, const u32 indent, const char* sid_name) {
+    switch (kind) {
+        case member_kind::POINTER: {
+            if (member >= m_currentFile->m_strings) {
+                insert_span_fmt("string: \"%s\"\n", member.as<char>());
+            }
+            else {
+                insert_struct_or_arraylike(member, indent);
+            }
+            break;
+        }
+        case member_kind::SID:
+        case member_kind::UNMAPPED_SID: {
+            insert_span_fmt("sid: %s\n", sid_name != nullptr ? sid_name : lookup(member.get<sid64>()));
+            break;
+        }
+        case member_kind::FLOAT: {
+            insert_span_fmt("float: %.2f\n", member.get<f32>());
+            break;
+        }
+        case member_kind::I32:
+        case member_kind::INT: {
+            insert_span_fmt("int: %d\n", member.get<i32>());
+            break;
+        }
     }
-    return member_size;
+    return get_member_kind_size(kind);
 }
 
 
 void Disassembler::disassemble() {
+    m_currentFile->build_struct_table(*m_sidbase);
     insert_header_line();
     for (i32 i = 0; i < m_currentFile->m_dcheader->m_numEntries; ++i) {
         insert_span("\n\n");
@@ -300,6 +411,22 @@ void Disassembler::insert_entry(const Entry *entry) {
 
 
 
+// every kind is assigned by name, so reordering struct_kind can't hand a struct to the wrong renderer
+static_assert(static_cast<u64>(struct_kind::COUNT) == 7, "a new struct kind needs a renderer below");
+const std::array<Disassembler::struct_renderer, static_cast<u64>(struct_kind::COUNT)> Disassembler::STRUCT_RENDERERS = [] {
+    std::array<struct_renderer, static_cast<u64>(struct_kind::COUNT)> renderers{};
+    renderers[static_cast<u64>(struct_kind::UNMAPPED)] = &Disassembler::insert_unmapped_struct_body;
+    renderers[static_cast<u64>(struct_kind::STATE_SCRIPT)] = &Disassembler::insert_state_script_body;
+    renderers[static_cast<u64>(struct_kind::SCRIPT_LAMBDA)] = &Disassembler::insert_script_lambda_body;
+    renderers[static_cast<u64>(struct_kind::MAP)] = &Disassembler::insert_map_body;
+    // arrays only get a type ID header when they're pointed at directly, they're printed like any other struct
+    renderers[static_cast<u64>(struct_kind::ARRAY)] = &Disassembler::insert_unmapped_struct_body;
+    renderers[static_cast<u64>(struct_kind::POINT_CURVE)] = &Disassembler::insert_point_curve_body;
+    renderers[static_cast<u64>(struct_kind::SYMBOL_ARRAY)] = &Disassembler::insert_symbol_array_body;
+    return renderers;
+}();
+
+
 void Disassembler::insert_struct(const structs::unmapped *struct_ptr, const u32 indent, const sid64 name_id) {
 
     const u64 offset = get_offset(&struct_ptr->m_data);
@@ -308,67 +435,121 @@ void Disassembler::insert_struct(const structs::unmapped *struct_ptr, const u32
     insert_span_fmt("%s [0x%05X] {\n", struct_name, offset);
     m_currentEmbeddedFunctionId.m_outerStructs.emplace_back(struct_name, offset);
 
-    switch (struct_ptr->typeID) {
-        case SID("state-script"): {
-            m_currentFile->m_dcscript = reinterpret_cast<const StateScript*>(&struct_ptr->m_data);
-            if (m_options.m_verbose) {
-                insert_state_script_verbose_fields(reinterpret_cast<const StateScript*>(&struct_ptr->m_data), indent + m_options.m_indentPerLevel);
-            }
-            insert_state_script(reinterpret_cast<const StateScript*>(&struct_ptr->m_data), indent + m_options.m_indentPerLevel);
-            break;
-        }
-        case SID("script-lambda"): {
-            if (m_options.m_verbose) {
-                insert_script_lambda_verbose_fields(reinterpret_cast<const ScriptLambda*>(&struct_ptr->m_data), indent + m_options.m_indentPerLevel);
-            }
-            bool already_emitted_func = m_offsetsToFunctionNames.contains(offset);
-            std::string name;
-            if (name_id == 0) {
-                m_currentEmbeddedFunctionId.m_outerStructs.pop_back();
-                name = m_currentEmbeddedFunctionId.to_string();
-                m_offsetsToFunctionNames[offset].push_back(name);
-                if (already_emitted_func) {
-                    break;
-                }
-            } else {
-                name = lookup(name_id);
-            }
-            function_disassembly function = create_function_disassembly(reinterpret_cast<const ScriptLambda*>(&struct_ptr->m_data), std::move(name));
-            function.m_isEmbeddedFunction = name_id == 0;
-            function.m_originalOffset = offset;
-            insert_function_disassembly_text(function, indent + m_options.m_indentPerLevel * 2);
-            m_functions.push_back(std::move(function));
-            break;
-        }
-        case SID("map"):
-        case SID("map-32"): {
-            const structs::map *map = reinterpret_cast<const structs::map*>(&struct_ptr->m_data);
-            insert_span_indent("%*skeys: [0x%05X], values: [0x%05X]\n\n", indent + m_options.m_indentPerLevel, get_offset(map->keys.data), get_offset(map->values.data));
-            for (u64 i = 0; i < map->size; ++i) {
-                const char *key_hash = lookup(map->keys[i]);
-                insert_span_indent("%*s%s {\n%*s", indent + m_options.m_indentPerLevel, key_hash, indent + m_options.m_indentPerLevel * 2, "");
-                const structs::unmapped *struct_ptr = reinterpret_cast<const structs::unmapped*>(map->values[i] - 8);
-                insert_struct(struct_ptr, indent + m_options.m_indentPerLevel * 2);
-                insert_span("}\n", indent + m_options.m_indentPerLevel);
-            }
-            break;
-        }
-        default: {
-            if (m_options.m_emitOnce && m_currentFile->m_emittedStructs.find(reinterpret_cast<p64>(struct_ptr)) != m_currentFile->m_emittedStructs.end()) {
-                insert_span_indent("%*sALREADY EMITTED\n%*s}\n", indent + m_options.m_indentPerLevel, indent, "");
-                return;
-            }
-            insert_unmapped_struct(struct_ptr, indent + m_options.m_indentPerLevel);
-            break;
-        }
+    const struct_renderer renderer = STRUCT_RENDERERS[static_cast<u64>(get_struct_kind(struct_ptr->typeID))];
+    if (!(this->*renderer)(struct_ptr, indent, name_id)) {
+        return;
     }
+
     if (!m_currentEmbeddedFunctionId.m_outerStructs.empty()) {
         m_currentEmbeddedFunctionId.m_outerStructs.pop_back();
     }
     insert_span("}\n", indent);
     if (m_options.m_emitOnce) {
-        m_currentFile->m_emittedStructs.emplace(reinterpret_cast<p64>(struct_ptr));
+        m_currentFile->set_emitted(struct_ptr);
+    }
+}
+
+
+bool Disassembler::insert_state_script_body(const structs::unmapped *struct_ptr, const u32 indent, const sid64) {
+    m_currentFile->m_dcscript = reinterpret_cast<const StateScript*>(&struct_ptr->m_data);
+    if (m_options.m_verbose) {
+        insert_state_script_verbose_fields(reinterpret_cast<const StateScript*>(&struct_ptr->m_data), indent + m_options.m_indentPerLevel);
     }
+    insert_state_script(reinterpret_cast<const StateScript*>(&struct_ptr->m_data), indent + m_options.m_indentPerLevel);
+    return true;
+}
+
+
+bool Disassembler::insert_script_lambda_body(const structs::unmapped *struct_ptr, const u32 indent, const sid64 name_id) {
+    const u64 offset = get_offset(&struct_ptr->m_data);
+    if (m_options.m_verbose) {
+        insert_script_lambda_verbose_fields(reinterpret_cast<const ScriptLambda*>(&struct_ptr->m_data), indent + m_options.m_indentPerLevel);
+    }
+    bool already_emitted_func = m_offsetsToFunctionNames.contains(offset);
+    std::string name;
+    if (name_id == 0) {
+        m_currentEmbeddedFunctionId.m_outerStructs.pop_back();
+        name = m_currentEmbeddedFunctionId.to_string();
+        m_offsetsToFunctionNames[offset].push_back(name);
+        if (already_emitted_func) {
+            return true;
+        }
+    } else {
+        name = lookup(name_id);
+    }
+    function_disassembly function = create_function_disassembly(reinterpret_cast<const ScriptLambda*>(&struct_ptr->m_data), std::move(name));
+    function.m_isEmbeddedFunction = name_id == 0;
+    function.m_originalOffset = offset;
+    insert_function_disassembly_text(function, indent + m_options.m_indentPerLevel * 2);
+    m_functions.push_back(std::move(function));
+    return true;
+}
+
+
+bool Disassembler::insert_map_body(const structs::unmapped *struct_ptr, const u32 indent, const sid64) {
+    const structs::map *map = reinterpret_cast<const structs::map*>(&struct_ptr->m_data);
+    insert_span_indent("%*skeys: [0x%05X], values: [0x%05X]\n\n", indent + m_options.m_indentPerLevel, get_offset(map->keys.data), get_offset(map->values.data));
+    for (u64 i = 0; i < map->size; ++i) {
+        const char *key_hash = lookup(map->keys[i]);
+        insert_span_indent("%*s%s {\n%*s", indent + m_options.m_indentPerLevel, key_hash, indent + m_options.m_indentPerLevel * 2, "");
+        const structs::unmapped *value_ptr = reinterpret_cast<const structs::unmapped*>(map->values[i] - 8);
+        insert_struct(value_ptr, indent + m_options.m_indentPerLevel * 2);
+        insert_span("}\n", indent + m_options.m_indentPerLevel);
+    }
+    return true;
+}
+
+
+bool Disassembler::insert_point_curve_body(const structs::unmapped *struct_ptr, const u32 indent, const sid64 name_id) {
+    const struct_table_entry* entry = m_currentFile->get_struct(&struct_ptr->m_data);
+    if (entry == nullptr || entry->m_size != sizeof(structs::point_curve)) {
+        return insert_unmapped_struct_body(struct_ptr, indent, name_id);
+    }
+    const structs::point_curve *curve = reinterpret_cast<const structs::point_curve*>(&struct_ptr->m_data);
+    insert_span_indent("%*s[0] int: %u\n", indent + m_options.m_indentPerLevel, curve->int1);
+    for (u32 i = 0; i < std::size(curve->floats); ++i) {
+        insert_span_indent("%*s[%u] float: %.2f\n", indent + m_options.m_indentPerLevel, i + 1, curve->floats[i]);
+    }
+    return true;
+}
+
+
+bool Disassembler::insert_symbol_array_body(const structs::unmapped *struct_ptr, const u32 indent, const sid64 name_id) {
+    const struct_table_entry* entry = m_currentFile->get_struct(&struct_ptr->m_data);
+    const structs::symbol_array *symbols = reinterpret_cast<const structs::symbol_array*>(&struct_ptr->m_data);
+    if (entry == nullptr || entry->m_size != sizeof(structs::symbol_array) || symbols->contents.keys.data == nullptr) {
+        return insert_unmapped_struct_body(struct_ptr, indent, name_id);
+    }
+    // the upper half of the size is an unknown field that's always 0
+    const u32 num_symbols = static_cast<u32>(symbols->contents.size);
+    insert_span_indent("%*ssymbols: [0x%05X]\n", indent + m_options.m_indentPerLevel, get_offset(symbols->contents.keys.data));
+    for (u32 i = 0; i < num_symbols; ++i) {
+        insert_span_indent("%*s[%u] symbol: %s\n", indent + m_options.m_indentPerLevel, i, lookup(symbols->contents.keys[i]));
+    }
+    return true;
+}
+
+
+bool Disassembler::insert_unmapped_struct_body(const structs::unmapped *struct_ptr, const u32 indent, const sid64) {
+    if (m_options.m_emitOnce) {
+        if (m_currentFile->is_emitted(struct_ptr)) {
+            insert_span_indent("%*sALREADY EMITTED\n%*s}\n", indent + m_options.m_indentPerLevel, indent, "");
+            return false;
+        }
+        // structs with the same type and contents as one that was already emitted somewhere else only get a back-reference
+        const struct_table_entry* entry = m_currentFile->get_struct(&struct_ptr->m_data);
+        if (entry != nullptr && entry->m_size >= MIN_DEDUP_SIZE) {
+            if (const auto emitted_offset = m_currentFile->find_emitted_content(struct_ptr, entry->m_size + 8)) {
+                // the content starts at the type ID, the struct's header prints the address of the data behind it
+                insert_span_indent("%*sALREADY EMITTED AS [0x%05X]\n%*s}\n", indent + m_options.m_indentPerLevel, *emitted_offset + 8, indent, "");
+                m_currentFile->set_emitted(struct_ptr);
+                return false;
+            }
+            m_currentFile->add_emitted_content(struct_ptr, entry->m_size + 8);
+        }
+    }
+    insert_unmapped_struct(struct_ptr, indent + m_options.m_indentPerLevel);
+    return true;
 }
 
 
@@ -1289,12 +1470,15 @@ void Disassembler::process_instruction(const u32 istr_idx, function_disassembly
                     offset += std::snprintf(comment_str + offset, sizeof(comment_str) - offset, "%s: ", builtin->second.m_arguments[i].first.c_str());
                 }
                 else {
-                    const auto arg_type = std::make_shared<ast::full_type>(frame[ARGUMENT_REGISTERS_IDX + i].m_type);
                     auto& ftype = frame.m_symbolTable.get_type(frame[dest].m_fromSymbolTable);
                     if (!std::holds_alternative<ast::function_type>(ftype)) {
                         ftype = ast::function_type{};
                     }
-                    std::get<ast::function_type>(ftype).m_arguments.emplace_back("", arg_type);
+                    // the signature is recorded by the first call that passes this argument, later calls reuse it
+                    auto& arguments = std::get<ast::function_type>(ftype).m_arguments;
+                    if (arguments.size() == i) {
+                        arguments.emplace_back("", ast::intern_type(frame[ARGUMENT_REGISTERS_IDX + i].m_type));
+                    }
                 }
                 frame.to_string(dst_str, interpreted_buffer_size, ARGUMENT_REGISTERS_IDX + i, lookup(frame[i + ARGUMENT_REGISTERS_IDX].m_value));
                 offset += std::snprintf(comment_str + offset, sizeof(comment_str) - offset, "%s", dst_str);
@@ -1306,7 +1490,9 @@ void Disassembler::process_instruction(const u32 istr_idx, function_disassembly
                     frame[ARGUMENT_REGISTERS_IDX + i++].m_type = *type;
                 }
             } else if (std::holds_alternative<ast::function_type>(frame[dest].m_type)) {
-                frame[dest].m_type = std::move(*std::get<ast::function_type>(frame[dest].m_type).m_return);
+                // copy first, the return type node is shared and the assignment destroys the function type holding it
+                ast::full_type return_type = *std::get<ast::function_type>(frame[dest].m_type).m_return;
+                frame[dest].m_type = std::move(return_type);
             }
             frame[dest].m_isReturn = true;
             frame[dest].m_pointerOffset = 0;
@@ -1770,8 +1956,8 @@ void Disassembler::insert_function_disassembly_text(const function_disassembly &
 void Disassembler::disassemble_functions_from_bin_file() {
     constexpr sid32 function_sid = 0xAB3EB31F;
     const location start = location(m_currentFile->m_bytes.get());
-    for (u64 i = 0; i < m_currentFile->m_size; i += 4) {
-        if (start.get<u32>(i) == function_sid) {
+    for (const u64 i : m_currentFile->find_u32(function_sid, m_options.m_numThreads)) {
+        if (i >= 16) {
             std::vector<Instruction> istrs;
             const ShortInstruction* instr_ptr = start.get<const ShortInstruction*>(i - 16);
             const std::byte* symbol_table = start.get<const std::byte*>(i - 8);
@@ -1785,7 +1971,7 @@ void Disassembler::disassemble_functions_from_bin_file() {
             
             auto function_disassembly = create_function_disassembly(std::move(istrs), "0x" + std::to_string(i), location(instr_ptr), false);
             m_functions.push_back(std::move(function_disassembly));
-            insert_function_disassembly_text(m_functions[0], 4);
+            insert_function_disassembly_text(m_functions.back(), 4);
         }
     }
 }
@@ -44,13 +44,33 @@ namespace dconstruct {
 
     void EditDisassembler::apply_edit(const u64 struct_offset, const u32 member_index, const BinaryFileEdit& value) noexcept {
         const location struct_member_start = location(m_currentFile->m_bytes.get()) + struct_offset;
+        // anonymous structs inside of arrays don't get pointed at, so those can't be bounds checked
+        const struct_table_entry* entry = m_currentFile->get_struct(struct_member_start);
+        if (entry != nullptr && !get_struct_kind_entry(entry->m_typeId).m_editable) {
+            std::cout << "warning: struct at location 0x" << std::hex << struct_offset << " is a " << lookup(entry->m_typeId)
+                << ", which can't be edited by member index. edit will not be applied.\n";
+            return;
+        }
         u32 member_location = 0;
         u32 last_member_size = 0;
         for (u32 i = 0; i < member_index; ++i) {
-            last_member_size = insert_next_struct_member(struct_member_start + member_location, 0);
+            if (entry != nullptr && member_location >= entry->m_size) {
+                break;
+            }
+            // pointers are always 8 bytes, no need to walk whatever they point at
+            if (m_currentFile->is_file_ptr(struct_member_start + member_location)) {
+                last_member_size = 8;
+            } else {
+                last_member_size = insert_next_struct_member(struct_member_start + member_location, 0);
+            }
             member_location += last_member_size;
         }
-        const u32 edit_member_size = insert_next_struct_member(struct_member_start + member_location, 0);
+        if (entry != nullptr && member_location >= entry->m_size && member_index != 0) {
+            std::cout << "warning: struct at location 0x" << std::hex << struct_offset << " has no member " << std::dec << member_index
+                << ". edit will not be applied.\n";
+            return;
+        }
+        const u32 edit_member_size = m_currentFile->is_file_ptr(struct_member_start + member_location) ? 8 : insert_next_struct_member(struct_member_start + member_location, 0);
         if (edit_member_size == 8 && (value.m_editType != EditType::SID_STR && value.m_editType != EditType::SID_HASH && value.m_editType != EditType::PTR)) {
             std::cout << "warning: member " << member_index << " of struct at location 0x" << std::hex << struct_offset
                 << " is size 8, but value passed is of size 4. edit will not be applied.\n";
@@ -108,6 +128,7 @@ namespace dconstruct {
     }
 
     void EditDisassembler::apply_file_edits() noexcept {
+        m_currentFile->build_struct_table(*m_sidbase);
         bool applied_at_least_one = false;
         u16 edit_index = 0;
         for (const auto& edit_str : m_edits) {
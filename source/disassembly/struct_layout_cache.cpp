@@ -0,0 +1,114 @@
+#include "disassembly/struct_layout_cache.h"
+#include <fstream>
+#include <mutex>
+
+namespace dconstruct {
+
+    [[nodiscard]] std::expected<void, std::string> StructLayoutCache::load(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) {
+            return std::unexpected{"couldn't open layout cache at path '" + path.string() + "'\n"};
+        }
+
+        u32 magic = 0, version = 0;
+        u64 num_layouts = 0;
+        in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        in.read(reinterpret_cast<char*>(&version), sizeof(version));
+        in.read(reinterpret_cast<char*>(&num_layouts), sizeof(num_layouts));
+        if (!in || magic != CACHE_MAGIC || version != CACHE_VERSION) {
+            return std::unexpected{"'" + path.string() + "' is not a layout cache or was written by a different version\n"};
+        }
+
+        std::unique_lock lock(m_mutex);
+        for (u64 i = 0; i < num_layouts; ++i) {
+            sid64 type_id = 0;
+            u32 sightings = 0, num_members = 0;
+            bool conflicting = false;
+            in.read(reinterpret_cast<char*>(&type_id), sizeof(type_id));
+            in.read(reinterpret_cast<char*>(&sightings), sizeof(sightings));
+            in.read(reinterpret_cast<char*>(&conflicting), sizeof(conflicting));
+            in.read(reinterpret_cast<char*>(&num_members), sizeof(num_members));
+            struct_layout layout{std::vector<member_kind>(num_members), sightings, conflicting};
+            in.read(reinterpret_cast<char*>(layout.m_members.data()), num_members);
+            if (!in) {
+                return std::unexpected{"layout cache '" + path.string() + "' is truncated\n"};
+            }
+            for (const member_kind kind : layout.m_members) {
+                if (kind > member_kind::INT) {
+                    return std::unexpected{"layout cache '" + path.string() + "' contains an invalid member kind\n"};
+                }
+            }
+            if (layout.m_sightings >= REQUIRED_SIGHTINGS && !layout.m_conflicting) {
+                m_confirmed.insert_or_assign(type_id, layout.m_members);
+            }
+            m_layouts.insert_or_assign(type_id, std::move(layout));
+        }
+        return {};
+    }
+
+
+    [[nodiscard]] std::expected<void, std::string> StructLayoutCache::save(const std::filesystem::path& path) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out.is_open()) {
+            return std::unexpected{"couldn't write layout cache to '" + path.string() + "'\n"};
+        }
+
+        std::shared_lock lock(m_mutex);
+        const u64 num_layouts = m_layouts.size();
+        out.write(reinterpret_cast<const char*>(&CACHE_MAGIC), sizeof(CACHE_MAGIC));
+        out.write(reinterpret_cast<const char*>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+        out.write(reinterpret_cast<const char*>(&num_layouts), sizeof(num_layouts));
+        for (const auto& [type_id, layout] : m_layouts) {
+            const u32 num_members = static_cast<u32>(layout.m_members.size());
+            out.write(reinterpret_cast<const char*>(&type_id), sizeof(type_id));
+            out.write(reinterpret_cast<const char*>(&layout.m_sightings), sizeof(layout.m_sightings));
+            out.write(reinterpret_cast<const char*>(&layout.m_conflicting), sizeof(layout.m_conflicting));
+            out.write(reinterpret_cast<const char*>(&num_members), sizeof(num_members));
+            out.write(reinterpret_cast<const char*>(layout.m_members.data()), num_members);
+        }
+        return {};
+    }
+
+
+    [[nodiscard]] const std::vector<member_kind>* StructLayoutCache::get_confirmed(const sid64 type_id) const {
+        const auto it = m_confirmed.find(type_id);
+        return it != m_confirmed.end() ? &it->second : nullptr;
+    }
+
+
+    void StructLayoutCache::add_sighting(const sid64 type_id, const std::vector<member_kind>& members) {
+        if (m_confirmed.contains(type_id)) {
+            return;
+        }
+        // the result only depends on which layouts were seen and how often, not on the order they come in
+        std::unique_lock lock(m_mutex);
+        auto& layout = m_layouts[type_id];
+        if (layout.m_conflicting) {
+            return;
+        }
+        if (layout.m_sightings == 0) {
+            layout.m_members = members;
+            layout.m_sightings = 1;
+        } else if (layout.m_members == members) {
+            ++layout.m_sightings;
+        } else {
+            layout = struct_layout{{}, 0, true};
+        }
+    }
+
+
+    [[nodiscard]] u64 StructLayoutCache::size() const {
+        std::shared_lock lock(m_mutex);
+        return m_layouts.size();
+    }
+
+
+    [[nodiscard]] u64 StructLayoutCache::num_confirmed() const {
+        std::shared_lock lock(m_mutex);
+        u64 confirmed = 0;
+        for (const auto& [type_id, layout] : m_layouts) {
+            confirmed += layout.m_sightings >= REQUIRED_SIGHTINGS && !layout.m_conflicting;
+        }
+        return confirmed;
+    }
+}
@@ -79,28 +79,54 @@ int main(int argc, char *argv[]) {
     const bool verbose = opts["verbose"].as<bool>();
     const bool decompile = !opts["no_decompile"].as<bool>();
     const bool optimize = !opts["no_optimize"].as<bool>();
-    const bool generate_graphs = opts["graphs"].as<bool>();
     const bool use_pascal_case = opts["pascal_case"].as<bool>();
     const bool show_warnings = opts["show_warnings"].as<bool>();
     const bool uc4 = opts["uc4"].as<bool>();
     const std::string language_type = opts["language"].as<std::string>();
+    const bool validate_layouts = opts["validate_layouts"].as<bool>();
 
-    const auto opt_print_func = dconstruct::disassembly::get_print_type(language_type);
-    if (!opt_print_func) {
+    const auto opt_outputs = dconstruct::disassembly::get_dcpl_outputs(language_type, use_pascal_case);
+    if (!opt_outputs) {
         std::cerr << "error: unknown language type: '" << language_type << "'\n";
         return -1;
     }
-    const auto print_func = *opt_print_func;
+    const auto& outputs = *opt_outputs;
+
+    std::optional<dconstruct::graph_format> graphs;
+    if (opts.count("graphs") > 0) {
+        graphs = dconstruct::disassembly::get_graph_format(opts["graphs"].as<std::string>());
+        if (!graphs) {
+            std::cerr << "error: unknown graph format: '" << opts["graphs"].as<std::string>() << "'\n";
+            return -1;
+        }
+    }
     
 
     if (opts.count("e") > 0) {
         std::vector<std::string> edit_strings = opts["e"].as<std::vector<std::string>>();
         edits.insert(edits.end(), edit_strings.begin(), edit_strings.end());
     }
+    dconstruct::StructLayoutCache layout_cache;
+    std::filesystem::path layout_cache_path;
+    if (opts.count("layout_cache") > 0) {
+        layout_cache_path = opts["layout_cache"].as<std::string>();
+        if (std::filesystem::exists(layout_cache_path)) {
+            const auto load_res = layout_cache.load(layout_cache_path);
+            if (!load_res) {
+                std::cerr << load_res.error();
+                return -1;
+            }
+        }
+    } else if (validate_layouts) {
+        std::cout << "warning: --validate_layouts has no effect without --layout_cache.\n";
+    }
+
     const dconstruct::DisassemblerOptions disassember_options {
         indent_per_level,
         emit_once,
         verbose,
+        layout_cache_path.empty() ? nullptr : &layout_cache,
+        validate_layouts,
     };
 
     auto base_exp = dconstruct::SIDBase::from_binary(sidbase_path);
@@ -110,6 +136,12 @@ int main(int argc, char *argv[]) {
     }
     const auto& base = *base_exp;
 
+    std::optional<dconstruct::dcompiler::ast_cache> ast_cache;
+    if (opts.count("ast_cache") > 0) {
+        ast_cache.emplace(opts["ast_cache"].as<std::string>(), base);
+    }
+    const dconstruct::dcompiler::ast_cache* ast_cache_ptr = ast_cache ? &*ast_cache : nullptr;
+
     if (std::filesystem::is_directory(filepath)) {
         if (!output_is_folder) {
             std::cout << "error: the input " << filepath << " is a folder, but output " << output << " is a file.\n";
@@ -119,30 +151,50 @@ int main(int argc, char *argv[]) {
             std::cout << "warning: edits ignored as input path is a directory. edits only work in single file disassembly.\n";
         }
         if (decompile) {
-            if (generate_graphs) {
+            if (graphs) {
                 std::filesystem::create_directory(output / "graphs");
             }
             if (uc4) {
-                dconstruct::disassembly::decompile_multiple<false>(filepath, output, base, disassember_options, generate_graphs, show_warnings, optimize, print_func, use_pascal_case);
+                dconstruct::disassembly::decompile_multiple<false>(filepath, output, base, disassember_options, graphs, show_warnings, optimize, outputs, ast_cache_ptr);
             } else {
-                dconstruct::disassembly::decompile_multiple<true>(filepath, output, base, disassember_options, generate_graphs, show_warnings, optimize, print_func, use_pascal_case);
+                dconstruct::disassembly::decompile_multiple<true>(filepath, output, base, disassember_options, graphs, show_warnings, optimize, outputs, ast_cache_ptr);
             }
         }
         else {
             dconstruct::disassembly::disassemble_multiple(filepath, output, base, disassember_options);
         }
     } else {
+        // a single file has every core to itself
+        dconstruct::DisassemblerOptions file_options = disassember_options;
+        file_options.m_numThreads = std::max(1u, std::thread::hardware_concurrency());
         const auto start = std::chrono::high_resolution_clock::now();
+        // state script tracks often repeat the same lambdas, so a single file benefits from the memo too
+        dconstruct::dcompiler::function_memo memo;
+        dconstruct::graph_queue graph_queue;
         if (decompile) {
             std::cout << "disassembling & decompiling " << filepath.filename() << "...\n";
-            dconstruct::disassembly::decomp_file(filepath, output, std::filesystem::path(output).replace_extension(".dcpl"), base, disassember_options, generate_graphs, print_func, show_warnings, optimize, edits, use_pascal_case, !uc4);
+            dconstruct::disassembly::decomp_file(filepath, output, std::filesystem::path(output).replace_extension(".dcpl"), base, file_options, graphs, outputs, show_warnings, optimize, edits, !uc4, ast_cache_ptr, &memo, &graph_queue);
         }
         else {
             std::cout << "disassembling " << filepath.filename() << "...\n";
-            dconstruct::disassembly::disasm_file(filepath, output, base, disassember_options, edits);
+            dconstruct::disassembly::disasm_file(filepath, output, base, file_options, edits);
         }
         const auto time_taken = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
         std::cout << "took " << time_taken.count() << "ms\n";
+        if (decompile) {
+            memo.print_stats(std::cout);
+            dconstruct::disassembly::render_queued_graphs(graph_queue);
+        }
+    }
+
+    if (!layout_cache_path.empty()) {
+        std::cout << "layout cache: " << layout_cache.size() << " layouts (" << layout_cache.num_confirmed() << " confirmed), "
+            << layout_cache.m_cachedInstances << " structs decoded from cached layouts, " << layout_cache.m_contradictions << " contradictions\n";
+        const auto save_res = layout_cache.save(layout_cache_path);
+        if (!save_res) {
+            std::cerr << save_res.error();
+            return -1;
+        }
     }
     return 0;
 }
\ No newline at end of file
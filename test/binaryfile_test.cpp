@@ -2,6 +2,8 @@
 #include "binaryfile.h"
 #include "decompilation/decomp_function.h"
 #include <fstream>
+#include <cstring>
+#include <algorithm>
 #include "compilation/function.h"
 #include "disassembly/file_disassembler.h"
 
@@ -84,5 +86,174 @@ namespace dconstruct::testing {
         }
     }
 
+    TEST(BINARYFILE, StructTable) {
+        BinaryFile file = *BinaryFile::from_path(R"(C:\Users\damix\Documents\GitHub\TLOU2Modding\dconstruct\test\dc_test_files\ss-wave-manager.bin)");
+        file.build_struct_table(base);
 
-}
\ No newline at end of file
+        const auto& entries = file.m_structs.m_entries;
+        ASSERT_FALSE(entries.empty());
+        for (u64 i = 0; i < entries.size(); ++i) {
+            const struct_table_entry& entry = entries[i];
+            if (i + 1 < entries.size()) {
+                EXPECT_LT(entry.m_offset, entries[i + 1].m_offset);
+                EXPECT_LE(entry.m_offset + entry.m_size, entries[i + 1].m_offset);
+            }
+            for (const u32 slot : file.m_structs.pointer_slots(entry)) {
+                EXPECT_TRUE(file.is_file_ptr(file.m_bytes.get() + slot));
+                EXPECT_GE(slot, entry.m_offset);
+                EXPECT_LT(slot, entry.m_offset + entry.m_size);
+            }
+            for (const u32 referrer : file.m_structs.referrers(entry)) {
+                const location pointer = location(file.m_bytes.get() + referrer);
+                EXPECT_EQ(file.get_struct(location().from(pointer)), &entry);
+            }
+        }
+    }
+
+    TEST(BINARYFILE, EmittedBitmap) {
+        BinaryFile file = *BinaryFile::from_path(R"(C:\Users\damix\Documents\GitHub\TLOU2Modding\dconstruct\test\dc_test_files\ss-wave-manager.bin)");
+        file.build_struct_table(base);
+
+        const auto& entries = file.m_structs.m_entries;
+        ASSERT_GE(entries.size(), 2);
+        const location first = file.m_bytes.get() + entries[0].m_offset;
+        const location second = file.m_bytes.get() + entries[1].m_offset;
+        EXPECT_FALSE(file.is_emitted(first));
+        EXPECT_FALSE(file.is_emitted(second));
+
+        file.set_emitted(first);
+        EXPECT_TRUE(file.is_emitted(first));
+        EXPECT_FALSE(file.is_emitted(second));
+        // neighbouring qwords have their own bits
+        EXPECT_FALSE(file.is_emitted(first + 8));
+
+        file.set_emitted(second);
+        EXPECT_TRUE(file.is_emitted(first));
+        EXPECT_TRUE(file.is_emitted(second));
+    }
+
+    TEST(BINARYFILE, EmittedContents) {
+        BinaryFile file = *BinaryFile::from_path(R"(C:\Users\damix\Documents\GitHub\TLOU2Modding\dconstruct\test\dc_test_files\ss-wave-manager.bin)");
+        file.build_struct_table(base);
+
+        const auto& entries = file.m_structs.m_entries;
+        ASSERT_FALSE(entries.empty());
+        const struct_table_entry& entry = entries.front();
+        const location loc = file.m_bytes.get() + entry.m_offset;
+
+        EXPECT_FALSE(file.find_emitted_content(loc, entry.m_size).has_value());
+        file.add_emitted_content(loc, entry.m_size);
+        const auto found = file.find_emitted_content(loc, entry.m_size);
+        ASSERT_TRUE(found.has_value());
+        EXPECT_EQ(*found, entry.m_offset);
+
+        // the same bytes with another size or element count are different contents
+        EXPECT_FALSE(file.find_emitted_content(loc, entry.m_size, 2).has_value());
+        if (entry.m_size > 8) {
+            EXPECT_FALSE(file.find_emitted_content(loc, entry.m_size - 8).has_value());
+        }
+
+        // every other struct only matches if its bytes are really the same
+        for (const struct_table_entry& other : entries) {
+            if (other.m_size != entry.m_size || &other == &entry) {
+                continue;
+            }
+            const bool same_bytes = std::memcmp(file.m_bytes.get() + other.m_offset, loc.m_ptr, entry.m_size) == 0;
+            EXPECT_EQ(file.find_emitted_content(file.m_bytes.get() + other.m_offset, other.m_size).has_value(), same_bytes);
+        }
+    }
+
+    TEST(BINARYFILE, EmitOnceDedup) {
+        const std::string filepath = R"(C:\Users\damix\Documents\GitHub\TLOU2Modding\dconstruct\test\dc_test_files\ss-wave-manager.bin)";
+        const std::filesystem::path full_path = std::filesystem::temp_directory_path() / "dconstruct_full.asm";
+        const std::filesystem::path once_path = std::filesystem::temp_directory_path() / "dconstruct_once.asm";
+
+        BinaryFile full_file = *BinaryFile::from_path(filepath);
+        FileDisassembler full{ &full_file, &base, full_path.string(), DisassemblerOptions{} };
+        full.disassemble();
+        full.dump();
+
+        DisassemblerOptions options;
+        options.m_emitOnce = true;
+        BinaryFile once_file = *BinaryFile::from_path(filepath);
+        FileDisassembler once{ &once_file, &base, once_path.string(), options };
+        once.disassemble();
+        once.dump();
+
+        const auto read_file = [](const std::filesystem::path& path) {
+            std::ifstream in(path);
+            return std::string{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+        };
+        const std::string full_text = read_file(full_path);
+        const std::string once_text = read_file(once_path);
+        EXPECT_EQ(full_text.find("ALREADY EMITTED"), std::string::npos);
+        EXPECT_NE(once_text.find("ALREADY EMITTED"), std::string::npos);
+        EXPECT_LT(once_text.size(), full_text.size());
+
+        std::filesystem::remove(full_path);
+        std::filesystem::remove(once_path);
+    }
+
+    TEST(BINARYFILE, FindU32) {
+        constexpr u32 value = 0xAB3EB31F;
+        constexpr u64 min_bytes = BinaryFile::FIND_U32_MIN_BYTES_PER_THREAD;
+        // big enough for 3 threads, with 12 bytes behind the last full vector that only the scalar loop looks at
+        const u64 size = 3 * min_bytes + 12;
+        auto bytes = std::make_unique<std::byte[]>(size);
+
+        std::vector<u64> expected;
+        const auto put = [&](const u64 offset) {
+            std::memcpy(bytes.get() + offset, &value, sizeof(value));
+            expected.push_back(offset);
+        };
+        put(0);
+        // every aligned offset around the places the file gets split at for 2 and 3 threads
+        for (const u64 split : { min_bytes, size / 2 & ~u64{ 3 }, 2 * min_bytes }) {
+            for (u64 offset = split - 128; offset < split + 128; offset += 4) {
+                put(offset);
+            }
+        }
+        put(size - 12);
+        put(size - 4);
+        std::ranges::sort(expected);
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        // not 4 byte aligned, so it's never found
+        std::memcpy(bytes.get() + 0x1002, &value, sizeof(value));
+
+        const BinaryFile file{ "find_u32.bin", size, std::move(bytes), nullptr };
+        EXPECT_EQ(file.find_u32(value), expected);
+        EXPECT_EQ(file.find_u32(value, 2), expected);
+        EXPECT_EQ(file.find_u32(value, 3), expected);
+        EXPECT_EQ(file.find_u32(value, 64), expected);
+        EXPECT_TRUE(file.find_u32(value + 1, 3).empty());
+    }
+
+    TEST(BINARYFILE, SIDBaseSearch32) {
+        // a sidbase with nothing but 32 bit hashes, like the one of uc4
+        const std::vector<std::pair<sid64, std::string>> sids = { { 0x100, "first" }, { 0x200, "second" }, { 0x300, "third" } };
+        std::string bytes(8 + sids.size() * sizeof(SIDBaseEntry), '\0');
+        *reinterpret_cast<u64*>(bytes.data()) = sids.size();
+        for (u64 i = 0; i < sids.size(); ++i) {
+            const SIDBaseEntry entry{ sids[i].first, bytes.size() };
+            std::memcpy(bytes.data() + 8 + i * sizeof(SIDBaseEntry), &entry, sizeof(entry));
+            bytes += sids[i].second;
+            bytes += '\0';
+        }
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "dconstruct_sidbase32.bin";
+        {
+            std::ofstream out(path, std::ios::binary);
+            out.write(bytes.data(), bytes.size());
+        }
+        const SIDBase sidbase = *SIDBase::from_binary(path);
+
+        EXPECT_STREQ(sidbase.search(sid32{ 0x100 }), "first");
+        EXPECT_STREQ(sidbase.search(sid32{ 0x200 }), "second");
+        EXPECT_STREQ(sidbase.search(sid32{ 0x300 }), "third");
+        EXPECT_EQ(sidbase.search(sid32{ 0x50 }), nullptr);
+        EXPECT_EQ(sidbase.search(sid32{ 0x250 }), nullptr);
+        EXPECT_EQ(sidbase.search(sid32{ 0x400 }), nullptr);
+        // the 64 bit search finds the same names
+        EXPECT_STREQ(sidbase.search(sid64{ 0x200 }), "second");
+        std::filesystem::remove(path);
+    }
+}
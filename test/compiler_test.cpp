@@ -1157,6 +1157,96 @@ const std::string DCPL_PATH = "C:/Users/damix/Documents/GitHub/TLOU2Modding/dcon
         EXPECT_EQ(semantic_errors, empty);
     }
 
+    TEST(COMPILER, NestedScopeShadowing) {
+        compilation::scope scope{};
+        const ast::full_type outer_type = ast::make_type_from_prim(ast::primitive_kind::U32);
+        const ast::full_type inner_type = ast::make_type_from_prim(ast::primitive_kind::STRING);
+        scope.define("x", outer_type);
+        scope.m_namesToTypes.emplace("Outer", outer_type);
+        scope.m_sidAliases["display"] = {SID("display"), "display"};
+        scope.m_expectedReturnType = &outer_type;
+        {
+            const compilation::scope::nested_scope inner{scope};
+            EXPECT_TRUE(scope.m_namesToTypes.empty());
+            EXPECT_TRUE(scope.m_sidAliases.empty());
+            ASSERT_NE(scope.lookup("x"), nullptr);
+            EXPECT_EQ(*scope.lookup("x"), outer_type);
+
+            scope.define("x", inner_type);
+            scope.m_sidAliases["inner"] = {SID("inner"), "inner"};
+            EXPECT_EQ(*scope.lookup("x"), inner_type);
+            EXPECT_EQ(scope.m_expectedReturnType, &outer_type);
+            scope.m_computedReturnType = true;
+        }
+        ASSERT_NE(scope.lookup("x"), nullptr);
+        EXPECT_EQ(*scope.lookup("x"), outer_type);
+        EXPECT_TRUE(scope.m_namesToTypes.contains("Outer"));
+        EXPECT_TRUE(scope.m_sidAliases.contains("display"));
+        EXPECT_FALSE(scope.m_sidAliases.contains("inner"));
+        EXPECT_TRUE(scope.m_computedReturnType);
+    }
+
+    TEST(COMPILER, NestedBlockShadowing) {
+        const std::string code =
+        "u32 main() {"
+        "    u32 x = 0;"
+        "    {"
+        "        string x = \"shadow\";"
+        "    }"
+        "    return x;"
+        "}";
+        auto [tokens, lex_errors] = get_tokens(code);
+        const auto [program, types, parse_errors] = get_parse_results(tokens);
+        EXPECT_EQ(lex_errors.size(), 0);
+        EXPECT_EQ(parse_errors.size(), 0);
+
+        compilation::scope scope{types};
+        std::vector<ast::semantic_check_error> semantic_errors = program.check_semantics(scope);
+
+        std::vector<ast::semantic_check_error> empty{};
+        EXPECT_EQ(semantic_errors, empty) << semantic_errors[0].m_message;
+    }
+
+    TEST(COMPILER, UsingVisibleInNestedBlock) {
+        const std::string code =
+        "using #display as far (string, u32) -> u0;"
+        "u32 main() {"
+        "    if (1) {"
+        "        display(\"nested\", 19);"
+        "    }"
+        "    return 0;"
+        "}";
+        auto [tokens, lex_errors] = get_tokens(code);
+        const auto [program, types, parse_errors] = get_parse_results(tokens);
+        EXPECT_EQ(lex_errors.size(), 0);
+        EXPECT_EQ(parse_errors.size(), 0);
+
+        compilation::scope scope{types};
+        std::vector<ast::semantic_check_error> semantic_errors = program.check_semantics(scope);
+        EXPECT_TRUE(scope.m_sidAliases.contains("display"));
+
+        std::vector<ast::semantic_check_error> empty{};
+        EXPECT_EQ(semantic_errors, empty) << semantic_errors[0].m_message;
+    }
+
+    TEST(COMPILER, ReturnInNestedBlockChecksFunctionType) {
+        const std::string code =
+        "u32 main() {"
+        "    if (1) {"
+        "        return \"wrong\";"
+        "    }"
+        "    return 0;"
+        "}";
+        auto [tokens, lex_errors] = get_tokens(code);
+        const auto [program, types, parse_errors] = get_parse_results(tokens);
+        EXPECT_EQ(lex_errors.size(), 0);
+        EXPECT_EQ(parse_errors.size(), 0);
+
+        compilation::scope scope{types};
+        std::vector<ast::semantic_check_error> semantic_errors = program.check_semantics(scope);
+        EXPECT_FALSE(semantic_errors.empty());
+    }
+
     TEST(COMPILER, FullCompile1) {
         const std::string code = 
             "i32 main() {"
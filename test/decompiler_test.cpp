@@ -1,7 +1,12 @@
 #include "BinaryFile.h"
+#include "decompilation/ast_cache.h"
 #include "decompilation/decomp_function.h"
+#include "decompilation/function_memo.h"
+#include "decompilation/graph_layout.h"
+#include "decompilation/graph_queue.h"
 #include "disassembly/file_disassembler.h"
 #include "ast/ast.h"
+#include "ast/optimization/optimization_stats.h"
 #include <array>
 #include <gtest/gtest.h>
 #include <filesystem>
@@ -40,6 +45,13 @@ namespace dconstruct::testing {
         return std::move(test);
     }
 
+    static function_disassembly disassemble_instructions(std::vector<Instruction>& istrs) {
+        BinaryFile file = *BinaryFile::from_path(TEST_DIR + R"(\dummy.bin)");
+        Disassembler da{ &file, &base };
+        // the lines point into istrs, so the caller keeps them alive
+        return da.create_function_disassembly(std::move(istrs), "Test", location{});
+    }
+
     static std::string get_decompiled_function_from_file(const std::string& path, const std::string& function_id, const bool optimize = false) {
         auto file_res = BinaryFile::from_path(path);
         if (!file_res) {
@@ -199,6 +211,58 @@ namespace dconstruct::testing {
         EXPECT_EQ(expected, os.str());
     }
 
+    TEST(DECOMPILER, LongArithmeticChain) {
+        constexpr u32 chain_length = 2000;
+        std::vector<Instruction> istrs = {
+            {Opcode::LoadU16Imm, 0, 1, 0},
+            {Opcode::LoadU16Imm, 1, 5, 0},
+        };
+        for (u32 i = 0; i < chain_length; ++i) {
+            istrs.push_back({Opcode::IAdd, 0, 0, 1});
+        }
+        istrs.push_back({Opcode::Return, 0, 0, 0});
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        const auto& func = decompile_instructions_with_disassembly(std::move(istrs), "LongArithmeticChain");
+        const auto stop = std::chrono::high_resolution_clock::now();
+        std::cout << chain_length << " chained adds took " << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << "ms\n";
+
+        std::ostringstream os;
+        os << *func.m_body.m_statements.front();
+        const std::string actual = os.str();
+        u32 add_count = 0;
+        for (auto pos = actual.find("+ 5"); pos != std::string::npos; pos = actual.find("+ 5", pos + 1)) {
+            ++add_count;
+        }
+        EXPECT_EQ(add_count, chain_length);
+    }
+
+    TEST(DECOMPILER, LongCallArgumentChain) {
+        constexpr u32 chain_length = 500;
+        std::vector<Instruction> istrs = {
+            {Opcode::LoadU16Imm, 2, 5, 0},
+        };
+        for (u32 i = 0; i < chain_length; ++i) {
+            istrs.push_back({Opcode::LookupPointer, 0, 0, 0});
+            istrs.push_back({Opcode::Move, 49, 2, 0});
+            istrs.push_back({Opcode::Call, 0, 0, 1});
+            istrs.push_back({Opcode::IAddImm, 2, 0, 1});
+        }
+        istrs.push_back({Opcode::Return, 2, 0, 0});
+        std::vector<u64> table_entries;
+        table_entries.push_back(SID("ddict-key-count"));
+        std::vector<ast::full_type> symbol_table_types;
+        symbol_table_types.push_back(ast::make_function(ast::make_type_from_prim(ast::primitive_kind::I32), { {"ddict", ast::make_type_from_prim(ast::primitive_kind::I32) } }));
+        SymbolTable table{ location(table_entries.data()), std::move(symbol_table_types) };
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        const auto& func = decompile_instructions_with_disassembly(std::move(istrs), "LongCallArgumentChain", std::move(table));
+        const auto stop = std::chrono::high_resolution_clock::now();
+        std::cout << chain_length << " chained calls took " << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << "ms\n";
+
+        EXPECT_FALSE(func.m_body.m_statements.empty());
+    }
+
 
     TEST(DECOMPILER, Call1) {
         std::vector<Instruction> istrs = {
@@ -226,6 +290,41 @@ namespace dconstruct::testing {
         EXPECT_EQ(expected, os.str());
     }
 
+    TEST(DECOMPILER, CallSignatureFromFirstCall) {
+        // the second call to the same symbol must not append its argument to the recorded signature again
+        std::vector<Instruction> istrs = {
+            {Opcode::LookupPointer, 0, 0, 0},
+            {Opcode::LoadU16Imm, 49, 5, 0},
+            {Opcode::Call, 0, 0, 1},
+            {Opcode::LookupPointer, 1, 0, 0},
+            {Opcode::LoadU16Imm, 49, 6, 0},
+            {Opcode::Call, 1, 1, 1},
+            {Opcode::Return, 1, 0, 0}
+        };
+        std::vector<u64> table_entries;
+        table_entries.push_back(SID("ddict-key-count"));
+        BinaryFile file = *BinaryFile::from_path(TEST_DIR + R"(\dummy.bin)");
+        Disassembler da{ &file, &base };
+        auto fd = da.create_function_disassembly(std::move(istrs), "CallTwice", location(table_entries.data()));
+
+        const auto& types = fd.m_stackFrame.m_symbolTable.m_types;
+        ASSERT_EQ(types.size(), 1);
+        ASSERT_TRUE(std::holds_alternative<ast::function_type>(types[0]));
+        EXPECT_EQ(std::get<ast::function_type>(types[0]).m_arguments.size(), 1);
+
+        auto dc_func = dcompiler::decomp_function{ fd, file, ControlFlowGraph::build(fd) };
+        const std::string expected =
+            "{\n"
+            "    ddict-key-count(5);\n"
+            "    u64? var_0 = ddict-key-count(6);\n"
+            "    return var_0;\n"
+            "}";
+
+        std::ostringstream os;
+        os << dc_func.decompile(false).m_body;
+        EXPECT_EQ(expected, os.str());
+    }
+
     TEST(DECOMPILER, FullFunc1) {
         const std::string filepath = TEST_DIR + R"(\ss-wave-manager.bin)";
         const std::string expected =
@@ -311,6 +410,346 @@ namespace dconstruct::testing {
         ASSERT_TRUE(registers_to_emit.test(0));
     }
     
+    TEST(DECOMPILER, ReadCountSameBranchTargets) {
+        // the branch's target is also its fallthrough, so the return is reached twice but still reads r1 once
+        std::vector<Instruction> istrs = {
+            {Opcode::LoadU16Imm, 0, 1, 0},
+            {Opcode::LoadU16Imm, 1, 5, 0},
+            {Opcode::BranchIf, 3, 0, 0},
+            {Opcode::Return, 1, 1, 0}
+        };
+        const auto fd = disassemble_instructions(istrs);
+        const auto graph = ControlFlowGraph::build(fd);
+        ASSERT_EQ(graph.m_nodes.size(), 2);
+        EXPECT_EQ(graph.get_register_read_count(graph[0], 1, 2), 1);
+    }
+
+    TEST(DECOMPILER, ReadCountLoopIntoStartNode) {
+        // r1 is overwritten inside the loop head, then read by the return and by the head itself on the next iteration
+        std::vector<Instruction> istrs = {
+            {Opcode::LoadU16Imm, 0, 1, 0},
+            {Opcode::LoadU16Imm, 1, 5, 0},
+            {Opcode::Move, 2, 1, 0},
+            {Opcode::LoadU16Imm, 1, 7, 0},
+            {Opcode::BranchIf, 6, 2, 0},
+            {Opcode::Branch, 2, 0, 0},
+            {Opcode::Return, 1, 1, 0}
+        };
+        const auto fd = disassemble_instructions(istrs);
+        const auto graph = ControlFlowGraph::build(fd);
+        ASSERT_EQ(graph.m_nodes.size(), 4);
+        ASSERT_EQ(graph[1].m_startLine, 2);
+        EXPECT_EQ(graph.get_register_read_count(graph[1], 1, 2), 2);
+    }
+
+    TEST(DECOMPILER, BranchPhiRegistersBehindRewrite) {
+        // both sides of the first if write r1 & r3. the second if rewrites r1 on one side only, the merge still reads both
+        std::vector<Instruction> istrs = {
+            {Opcode::LoadU16Imm, 0, 1, 0},
+            {Opcode::BranchIf, 5, 0, 0},
+            {Opcode::LoadU16Imm, 1, 1, 0},
+            {Opcode::LoadU16Imm, 3, 1, 0},
+            {Opcode::Branch, 7, 0, 0},
+            {Opcode::LoadU16Imm, 1, 2, 0},
+            {Opcode::LoadU16Imm, 3, 2, 0},
+            {Opcode::BranchIf, 10, 0, 0},
+            {Opcode::Move, 2, 0, 0},
+            {Opcode::Branch, 11, 0, 0},
+            {Opcode::LoadU16Imm, 1, 3, 0},
+            {Opcode::IAdd, 1, 1, 3},
+            {Opcode::Return, 1, 1, 0}
+        };
+        const auto fd = disassemble_instructions(istrs);
+        const auto graph = ControlFlowGraph::build(fd);
+        ASSERT_EQ(graph.m_nodes.size(), 7);
+        EXPECT_EQ(graph.get_branch_phi_registers(graph[0]), reg_set{0b1010});
+    }
+
+    TEST(DECOMPILER, LoopPhiRegisters) {
+        std::vector<Instruction> istrs = {
+            {Opcode::LoadU16Imm, 0, 1, 0},
+            {Opcode::LoadU16Imm, 1, 0, 0},
+            {Opcode::BranchIf, 5, 0, 0},
+            {Opcode::IAddImm, 1, 1, 1},
+            {Opcode::Branch, 2, 0, 0},
+            {Opcode::Move, 2, 1, 0},
+            {Opcode::Return, 2, 2, 0}
+        };
+        const auto fd = disassemble_instructions(istrs);
+        const auto graph = ControlFlowGraph::build(fd);
+        ASSERT_EQ(graph.m_nodes.size(), 4);
+        ASSERT_EQ(graph.m_loops.size(), 1);
+        EXPECT_EQ(graph.get_loop_phi_registers(graph[1], graph[1]), reg_set{0b10});
+    }
+    
+    TEST(DECOMPILER, ReadCountSameBranchTargetsOutput) {
+        // the call's result is read once behind a branch that goes to the same node either way. this used to count as two reads,
+        // which doesn't show in the output because every call whose result is read at all gets a variable
+        std::vector<Instruction> istrs = {
+            {Opcode::LookupPointer, 0, 0, 0},
+            {Opcode::LoadU16Imm, 49, 5, 0},
+            {Opcode::Call, 0, 0, 1},
+            {Opcode::LoadU16Imm, 1, 1, 0},
+            {Opcode::BranchIf, 5, 1, 0},
+            {Opcode::IAddImm, 2, 0, 3},
+            {Opcode::Return, 2, 2, 0}
+        };
+        std::vector<u64> table_entries;
+        table_entries.push_back(SID("ddict-key-count"));
+        std::vector<ast::full_type> symbol_table_types;
+        symbol_table_types.push_back(ast::make_function(ast::make_type_from_prim(ast::primitive_kind::I32), { {"ddict", ast::make_type_from_prim(ast::primitive_kind::I32) } }));
+        SymbolTable table{ location(table_entries.data()), std::move(symbol_table_types) };
+        const auto& func = decompile_instructions_with_disassembly(std::move(istrs), "SameBranchTargets", std::move(table));
+
+        const std::string expected =
+            "{\n"
+            "    u64? var_0 = ddict-key-count(5);\n"
+            "    bool var_1 = 1;\n"
+            "    return var_0 + 3;\n"
+            "}";
+        std::ostringstream os;
+        os << func.m_body;
+        EXPECT_EQ(expected, os.str());
+    }
+
+    TEST(DECOMPILER, ReadCountLoopIntoStartNodeOutput) {
+        // the call's result is only read at the top of the loop head, on the next iteration. that read used to be missed, so the
+        // call was printed as a statement and its result dropped. the loop itself isn't rebuilt from this shape yet
+        std::vector<Instruction> istrs = {
+            {Opcode::LoadU16Imm, 1, 0, 0},
+            {Opcode::Move, 2, 1, 0},
+            {Opcode::LookupPointer, 1, 0, 0},
+            {Opcode::LoadU16Imm, 49, 5, 0},
+            {Opcode::Call, 1, 1, 1},
+            {Opcode::BranchIf, 7, 2, 0},
+            {Opcode::Branch, 1, 0, 0},
+            {Opcode::Return, 2, 2, 0}
+        };
+        std::vector<u64> table_entries;
+        table_entries.push_back(SID("ddict-key-count"));
+        std::vector<ast::full_type> symbol_table_types;
+        symbol_table_types.push_back(ast::make_function(ast::make_type_from_prim(ast::primitive_kind::I32), { {"ddict", ast::make_type_from_prim(ast::primitive_kind::I32) } }));
+        SymbolTable table{ location(table_entries.data()), std::move(symbol_table_types) };
+        const auto& func = decompile_instructions_with_disassembly(std::move(istrs), "LoopIntoStartNode", std::move(table));
+
+        const std::string expected =
+            "{\n"
+            "    u64? var_0 = ddict-key-count(5);\n"
+            "    while (0) {}\n"
+            "\n"
+            "    return 0;\n"
+            "}";
+        std::ostringstream os;
+        os << func.m_body;
+        EXPECT_EQ(expected, os.str());
+    }
+
+    TEST(DECOMPILER, BranchPhiRegistersBehindRewriteOutput) {
+        // the function of BranchPhiRegistersBehindRewrite. r3 used to be missing from the first if's phi set because the second if
+        // rewrites r1 on one side, so it got no variable and the merge read r1's value in its place
+        std::vector<Instruction> istrs = {
+            {Opcode::LoadU16Imm, 0, 1, 0},
+            {Opcode::BranchIf, 5, 0, 0},
+            {Opcode::LoadU16Imm, 1, 1, 0},
+            {Opcode::LoadU16Imm, 3, 1, 0},
+            {Opcode::Branch, 7, 0, 0},
+            {Opcode::LoadU16Imm, 1, 2, 0},
+            {Opcode::LoadU16Imm, 3, 2, 0},
+            {Opcode::BranchIf, 10, 0, 0},
+            {Opcode::Move, 2, 0, 0},
+            {Opcode::Branch, 11, 0, 0},
+            {Opcode::LoadU16Imm, 1, 3, 0},
+            {Opcode::IAdd, 1, 1, 3},
+            {Opcode::Return, 1, 1, 0}
+        };
+        const auto& func = decompile_instructions_with_disassembly(std::move(istrs), "PhiBehindRewrite");
+
+        const std::string expected =
+            "{\n"
+            "    u16 var_0;\n"
+            "    u16 var_1;\n"
+            "    if (1) {\n"
+            "        var_0 = 1;\n"
+            "        var_1 = 1;\n"
+            "    } else {\n"
+            "        var_0 = 2;\n"
+            "        var_1 = 2;\n"
+            "    }\n"
+            "    u16 var_2;\n"
+            "    if (1) {\n"
+            "        var_2 = var_0;\n"
+            "    } else {\n"
+            "        var_2 = 3;\n"
+            "    }\n"
+            "    return var_2 + var_1;\n"
+            "}";
+        std::ostringstream os;
+        os << func.m_body;
+        EXPECT_EQ(expected, os.str());
+    }
+
+    TEST(DECOMPILER, IfRegionsFromPostdominators) {
+        std::vector<Instruction> if_then = {
+            {Opcode::LoadU16Imm, 0, 1, 0},
+            {Opcode::BranchIf, 3, 0, 0},
+            {Opcode::LoadU16Imm, 1, 2, 0},
+            {Opcode::Return, 1, 1, 0}
+        };
+        const auto fd_then = disassemble_instructions(if_then);
+        const auto graph_then = ControlFlowGraph::build(fd_then);
+        ASSERT_EQ(graph_then.m_nodes.size(), 3);
+        EXPECT_TRUE(graph_then.postdominates(2, 1));
+        EXPECT_FALSE(graph_then.postdominates(1, 0));
+        EXPECT_EQ(graph_then.m_regions[0].m_kind, region_kind::if_then);
+        EXPECT_EQ(graph_then.m_regions[0].m_follow, 2);
+
+        std::vector<Instruction> if_else = {
+            {Opcode::LoadU16Imm, 0, 1, 0},
+            {Opcode::BranchIf, 4, 0, 0},
+            {Opcode::LoadU16Imm, 1, 1, 0},
+            {Opcode::Branch, 5, 0, 0},
+            {Opcode::LoadU16Imm, 1, 2, 0},
+            {Opcode::Return, 1, 1, 0}
+        };
+        const auto fd_else = disassemble_instructions(if_else);
+        const auto graph_else = ControlFlowGraph::build(fd_else);
+        ASSERT_EQ(graph_else.m_nodes.size(), 4);
+        EXPECT_FALSE(graph_else.postdominates(2, 1));
+        EXPECT_TRUE(graph_else.postdominates(3, 1));
+        EXPECT_TRUE(graph_else.postdominates(3, 2));
+        EXPECT_EQ(graph_else.m_regions[0].m_kind, region_kind::if_else);
+        EXPECT_EQ(graph_else.m_regions[0].m_follow, 3);
+    }
+
+    TEST(DECOMPILER, LoopsNested) {
+        std::vector<Instruction> istrs = {
+            {Opcode::LoadU16Imm, 0, 1, 0},
+            {Opcode::LoadU16Imm, 1, 0, 0},
+            {Opcode::BranchIfNot, 8, 0, 0},
+            {Opcode::LoadU16Imm, 2, 0, 0},
+            {Opcode::BranchIfNot, 7, 0, 0},
+            {Opcode::IAddImm, 2, 2, 1},
+            {Opcode::Branch, 4, 0, 0},
+            {Opcode::Branch, 2, 0, 0},
+            {Opcode::Return, 1, 1, 0}
+        };
+        const auto fd = disassemble_instructions(istrs);
+        const auto graph = ControlFlowGraph::build(fd);
+        ASSERT_EQ(graph.m_nodes.size(), 7);
+        ASSERT_EQ(graph.m_loops.size(), 2);
+
+        const auto& outer = graph.m_loops[0];
+        EXPECT_EQ(outer.m_headNode, 1);
+        EXPECT_EQ(outer.m_latchNode, 5);
+        EXPECT_EQ(outer.m_parent, control_flow_loop::invalid_loop);
+        EXPECT_EQ(outer.m_body, (std::vector<node_id>{1, 2, 3, 4, 5}));
+        EXPECT_EQ(outer.m_exits, std::vector<node_id>{6});
+        EXPECT_EQ(outer.m_children, std::vector<node_id>{1});
+
+        const auto& inner = graph.m_loops[1];
+        EXPECT_EQ(inner.m_headNode, 3);
+        EXPECT_EQ(inner.m_latchNode, 4);
+        EXPECT_EQ(inner.m_parent, 0);
+        EXPECT_EQ(inner.m_body, (std::vector<node_id>{3, 4}));
+        EXPECT_EQ(inner.m_exits, std::vector<node_id>{5});
+        EXPECT_EQ(graph.get_loop_with_head(3), &inner);
+    }
+
+    TEST(DECOMPILER, LoopsSharedHeader) {
+        // two back edges into the same head are one loop, the first one is the latch
+        std::vector<Instruction> istrs = {
+            {Opcode::LoadU16Imm, 0, 1, 0},
+            {Opcode::BranchIfNot, 6, 0, 0},
+            {Opcode::BranchIf, 5, 0, 0},
+            {Opcode::IAddImm, 1, 1, 1},
+            {Opcode::Branch, 1, 0, 0},
+            {Opcode::Branch, 1, 0, 0},
+            {Opcode::Return, 1, 1, 0}
+        };
+        const auto fd = disassemble_instructions(istrs);
+        const auto graph = ControlFlowGraph::build(fd);
+        ASSERT_EQ(graph.m_nodes.size(), 6);
+        ASSERT_EQ(graph.m_loops.size(), 1);
+        const auto& loop = graph.m_loops[0];
+        EXPECT_EQ(loop.m_headNode, 1);
+        EXPECT_EQ(loop.m_latchNode, 3);
+        EXPECT_EQ(loop.m_body, (std::vector<node_id>{1, 2, 3, 4}));
+        EXPECT_EQ(loop.m_exits, std::vector<node_id>{5});
+        EXPECT_TRUE(loop.m_children.empty());
+    }
+
+    TEST(DECOMPILER, LoopsIrreducible) {
+        // the cycle between lines 2 and 4 is also entered at line 3 from line 7, so neither node dominates the other
+        std::vector<Instruction> istrs = {
+            {Opcode::LoadU16Imm, 0, 1, 0},
+            {Opcode::BranchIf, 6, 0, 0},
+            {Opcode::IAddImm, 1, 1, 1},
+            {Opcode::IAddImm, 1, 1, 2},
+            {Opcode::BranchIf, 2, 0, 0},
+            {Opcode::Branch, 8, 0, 0},
+            {Opcode::IAddImm, 1, 1, 3},
+            {Opcode::Branch, 3, 0, 0},
+            {Opcode::Return, 1, 1, 0}
+        };
+        const auto fd = disassemble_instructions(istrs);
+        const auto graph = ControlFlowGraph::build(fd);
+        ASSERT_EQ(graph.m_nodes.size(), 6);
+        EXPECT_FALSE(graph.dominates(1, 2));
+        EXPECT_FALSE(graph.dominates(2, 4));
+        EXPECT_TRUE(graph.m_loops.empty());
+    }
+
+    TEST(DECOMPILER, LoopsIrreducibleOutput) {
+        // the cycle of LoopsIrreducible with the counter initialized. it has no loop, so the emitter prints the two entries into
+        // the cycle as branches and the back edges aren't printed at all. this is what the output looks like until irreducible
+        // graphs are split into loops, with a loop that has a side entry the emitter crashed instead
+        std::vector<Instruction> istrs = {
+            {Opcode::LoadU16Imm, 0, 1, 0},
+            {Opcode::LoadU16Imm, 1, 0, 0},
+            {Opcode::BranchIf, 7, 0, 0},
+            {Opcode::IAddImm, 1, 1, 1},
+            {Opcode::IAddImm, 1, 1, 2},
+            {Opcode::BranchIf, 3, 0, 0},
+            {Opcode::Branch, 9, 0, 0},
+            {Opcode::IAddImm, 1, 1, 3},
+            {Opcode::Branch, 4, 0, 0},
+            {Opcode::Return, 1, 1, 0}
+        };
+        const auto func = decompile_instructions_with_disassembly(std::move(istrs));
+        const std::string expected =
+            "{\n"
+            "    u8 var_0;\n"
+            "    if (1) {\n"
+            "        var_0 = 0 + 1;\n"
+            "    } else {\n"
+            "        var_0 = var_0 + 3;\n"
+            "    }\n"
+            "    u8 var_1;\n"
+            "    if (1) {\n"
+            "        var_1 = var_0 + 2;\n"
+            "    }\n"
+            "    return var_1;\n"
+            "}";
+        std::ostringstream os;
+        os << func.m_body;
+        EXPECT_EQ(expected, os.str());
+    }
+
+    TEST(DECOMPILER, EmptyFunctionGraph) {
+        std::vector<Instruction> istrs;
+        const auto fd = disassemble_instructions(istrs);
+        const auto graph = ControlFlowGraph::build(fd);
+        ASSERT_EQ(graph.m_nodes.size(), 1);
+        EXPECT_TRUE(graph.m_nodes[0].m_lines.empty());
+        EXPECT_EQ(graph.m_regions[0].m_kind, region_kind::block);
+        EXPECT_EQ(graph.m_regions[0].m_follow, control_flow_node::invalid_node);
+
+        const control_flow_image image = graph.get_image();
+        ASSERT_EQ(image.m_labels.size(), 1);
+        EXPECT_TRUE(image.m_edges.empty());
+        EXPECT_TRUE(image.m_edgeColors.empty());
+    }
+
     TEST(DECOMPILER, If1) {
         const std::string filepath = TEST_DIR + R"(\ss-wave-manager.bin)";
         const std::string id = "#8A8D5C923D5DDB3B";
@@ -513,6 +952,286 @@ namespace dconstruct::testing {
         const auto stop = std::chrono::high_resolution_clock::now();
         const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
         std::cout << "took " << duration << "ms\n";
+        dconstruct::ast::g_optimizationStats.print(std::cout);
+    }
+
+    TEST(DECOMPILER, PrintBenchmark) {
+        const std::string filepath =  R"(C:\Program Files (x86)\Steam\steamapps\common\The Last of Us Part II\build\pc\main\bin_unpacked\dc1\ss\ss-ground-animal-flee.bin)";
+        auto file_res = BinaryFile::from_path(filepath);
+        if (!file_res) {
+            std::cerr << file_res.error() << "\n";
+            std::terminate();
+        }
+        auto& file = *file_res;
+        Disassembler da{ &file, &base };
+        da.disassemble();
+        std::vector<ast::function_definition> functions;
+        for (const auto* func : da.get_named_functions()) {
+            try {
+                functions.push_back(dcompiler::decomp_function{ *func, file, ControlFlowGraph::build(*func) }.decompile(true));
+            }
+            catch (const std::exception& e) {
+                std::cout << e.what();
+            }
+        }
+
+        constexpr u32 iterations = 50;
+        const std::pair<const char*, ast::print_fn_type> languages[] = { {"c", ast::c}, {"py", ast::py}, {"racket", ast::racket} };
+        for (const auto& [name, language] : languages) {
+            std::string stream_text;
+            const auto stream_start = std::chrono::high_resolution_clock::now();
+            for (u32 i = 0; i < iterations; ++i) {
+                std::ostringstream os;
+                os << language;
+                for (const auto& func : functions) {
+                    os << func;
+                }
+                if (i + 1 == iterations) {
+                    stream_text = std::move(os).str();
+                }
+            }
+            const auto stream_stop = std::chrono::high_resolution_clock::now();
+
+            std::string writer_text;
+            const auto writer_start = std::chrono::high_resolution_clock::now();
+            for (u32 i = 0; i < iterations; ++i) {
+                ast::code_writer os{ ast::print_options{ language } };
+                for (const auto& func : functions) {
+                    os << func;
+                }
+                if (i + 1 == iterations) {
+                    writer_text = os.view();
+                }
+            }
+            const auto writer_stop = std::chrono::high_resolution_clock::now();
+
+            ASSERT_EQ(stream_text, writer_text);
+            std::cout << name << ": ostringstream " << std::chrono::duration_cast<std::chrono::milliseconds>(stream_stop - stream_start).count()
+                      << "ms, code_writer " << std::chrono::duration_cast<std::chrono::milliseconds>(writer_stop - writer_start).count() << "ms\n";
+        }
+    }
+
+    TEST(DECOMPILER, SerializeRoundTrip) {
+        const std::string filepath =  R"(C:\Program Files (x86)\Steam\steamapps\common\The Last of Us Part II\build\pc\main\bin_unpacked\dc1\ss\ss-ground-animal-flee.bin)";
+        auto file_res = BinaryFile::from_path(filepath);
+        if (!file_res) {
+            std::cerr << file_res.error() << "\n";
+            std::terminate();
+        }
+        auto& file = *file_res;
+        Disassembler da{ &file, &base };
+        da.disassemble();
+
+        const auto decomp_start = std::chrono::high_resolution_clock::now();
+        std::vector<ast::function_definition> functions;
+        for (const auto* func : da.get_named_functions()) {
+            try {
+                functions.push_back(dcompiler::decomp_function{ *func, file, ControlFlowGraph::build(*func) }.decompile(true));
+            }
+            catch (const std::exception& e) {
+                std::cout << e.what();
+            }
+        }
+        const auto decomp_stop = std::chrono::high_resolution_clock::now();
+
+        const std::pair<const char*, ast::print_fn_type> languages[] = { {"c", ast::c}, {"py", ast::py}, {"racket", ast::racket} };
+        std::vector<std::string> expected;
+        for (const auto& [name, language] : languages) {
+            ast::code_writer os{ ast::print_options{ language } };
+            for (const auto& func : functions) {
+                os << func;
+            }
+            expected.push_back(os.take());
+        }
+
+        ast::ast_writer writer;
+        writer.write(functions);
+
+        const auto load_start = std::chrono::high_resolution_clock::now();
+        ast::ast_reader reader{ writer.data() };
+        const u32 count = reader.read_count();
+        std::vector<ast::function_definition> loaded;
+        for (u32 i = 0; i < count; ++i) {
+            loaded.push_back(reader.read_function());
+        }
+        const auto load_stop = std::chrono::high_resolution_clock::now();
+
+        ASSERT_FALSE(reader.failed());
+        ASSERT_TRUE(reader.at_end());
+        ASSERT_EQ(loaded.size(), functions.size());
+        for (u32 i = 0; i < std::size(languages); ++i) {
+            ast::code_writer os{ ast::print_options{ languages[i].second } };
+            for (const auto& func : loaded) {
+                os << func;
+            }
+            EXPECT_EQ(os.view(), expected[i]);
+        }
+
+        ast::ast_reader truncated{ std::span{ writer.data() }.first(writer.data().size() / 2) };
+        const u32 truncated_count = truncated.read_count();
+        for (u32 i = 0; i < truncated_count && !truncated.failed(); ++i) {
+            (void)truncated.read_function();
+        }
+        EXPECT_TRUE(truncated.failed());
+
+        std::cout << writer.data().size() << " bytes, decompiling " << std::chrono::duration_cast<std::chrono::milliseconds>(decomp_stop - decomp_start).count()
+                  << "ms, loading " << std::chrono::duration_cast<std::chrono::milliseconds>(load_stop - load_start).count() << "ms\n";
+    }
+
+    TEST(DECOMPILER, FunctionMemo) {
+        const std::string filepath =  R"(C:\Program Files (x86)\Steam\steamapps\common\The Last of Us Part II\build\pc\main\bin_unpacked\dc1\ss\ss-ground-animal-flee.bin)";
+        auto file_res = BinaryFile::from_path(filepath);
+        if (!file_res) {
+            std::cerr << file_res.error() << "\n";
+            std::terminate();
+        }
+        auto& file = *file_res;
+        Disassembler da{ &file, &base };
+        da.disassemble();
+
+        dcompiler::function_memo memo;
+        u64 copies = 0;
+        for (const auto* func : da.get_all_functions()) {
+            std::string expected;
+            try {
+                expected = dcompiler::decomp_function{ *func, file, ControlFlowGraph::build(*func) }.decompile(true).to_c_string();
+            }
+            catch (const std::exception&) {
+                continue;
+            }
+            const auto key = dcompiler::function_memo::get_key(*func, file, true);
+            auto memoized = memo.find(key, func->m_id);
+            if (!memoized) {
+                memo.insert(key, dcompiler::decomp_function{ *func, file, ControlFlowGraph::build(*func) }.decompile(true));
+                memoized = memo.find(key, func->m_id);
+            } else {
+                ++copies;
+            }
+            ASSERT_TRUE(memoized && *memoized);
+            EXPECT_EQ((*memoized)->to_c_string(), expected);
+        }
+        std::cout << copies << " copies\n";
+        memo.print_stats(std::cout);
+    }
+
+    TEST(DECOMPILER, FunctionMemoKeyContent) {
+        std::vector<Instruction> istrs = {
+            {Opcode::LoadU16Imm, 0, 5, 0},
+            {Opcode::Return, 0, 0, 0}
+        };
+        BinaryFile file = *BinaryFile::from_path(TEST_DIR + R"(\dummy.bin)");
+        const auto fd = disassemble_instructions(istrs);
+        const auto key = dcompiler::function_memo::get_key(fd, file, true);
+
+        dcompiler::function_memo memo;
+        memo.insert(key, dcompiler::decomp_function{ fd, file, ControlFlowGraph::build(fd) }.decompile(true));
+
+        // a key with the same hash but different content is a different function
+        auto same_hash = key;
+        same_hash.m_content.back() ^= std::byte{ 1 };
+        EXPECT_FALSE(memo.find(same_hash, std::string("Other")).has_value());
+
+        const auto hit = memo.find(key, std::string("Copy"));
+        ASSERT_TRUE(hit && *hit);
+        const std::string expected =
+            "u16 Copy() {\n"
+            "    return 5;\n"
+            "}";
+        EXPECT_EQ((*hit)->to_c_string(), expected);
+    }
+
+    TEST(DECOMPILER, AstCacheKeySidbase) {
+        // same entry count, lowest and highest sid every time, only the name in the middle changes
+        const auto make_sidbase = [](const std::string& middle_name) {
+            const std::array<std::pair<sid64, std::string>, 3> sids{{ {0x10, "first"}, {0x20, middle_name}, {0x30, "last"} }};
+            u64 offset = sizeof(u64) + sids.size() * sizeof(SIDBaseEntry);
+            std::size_t size = offset;
+            for (const auto& [sid, name] : sids) {
+                size += name.size() + 1;
+            }
+            auto bytes = std::make_unique<std::byte[]>(size);
+            *reinterpret_cast<u64*>(bytes.get()) = sids.size();
+            auto* entries = reinterpret_cast<SIDBaseEntry*>(bytes.get() + sizeof(u64));
+            for (u64 i = 0; i < sids.size(); ++i) {
+                entries[i] = SIDBaseEntry{ sids[i].first, offset };
+                std::memcpy(bytes.get() + offset, sids[i].second.c_str(), sids[i].second.size() + 1);
+                offset += sids[i].second.size() + 1;
+            }
+            return SIDBase{ sids.size(), std::move(bytes), entries, sids.front().first, sids.back().first };
+        };
+
+        const std::array<std::byte, 4> file{ std::byte{0xDC}, std::byte{0x01}, std::byte{0x02}, std::byte{0x03} };
+        const dcompiler::ast_cache cache{ DCPL_PATH, make_sidbase("middle") };
+        const dcompiler::ast_cache same_cache{ DCPL_PATH, make_sidbase("middle") };
+        const dcompiler::ast_cache other_cache{ DCPL_PATH, make_sidbase("center") };
+
+        const u64 key = cache.get_key(file.data(), file.size(), true, true);
+        EXPECT_EQ(key, same_cache.get_key(file.data(), file.size(), true, true));
+        EXPECT_NE(key, other_cache.get_key(file.data(), file.size(), true, true));
+        EXPECT_NE(key, cache.get_key(file.data(), file.size(), false, true));
+    }
+
+    TEST(DECOMPILER, GraphFormats) {
+        const std::string filepath =  R"(C:\Program Files (x86)\Steam\steamapps\common\The Last of Us Part II\build\pc\main\bin_unpacked\dc1\ss\ss-ground-animal-flee.bin)";
+        auto file_res = BinaryFile::from_path(filepath);
+        if (!file_res) {
+            std::cerr << file_res.error() << "\n";
+            std::terminate();
+        }
+        auto& file = *file_res;
+        Disassembler da{ &file, &base };
+        da.disassemble();
+
+        const std::filesystem::path graph_dir = DCPL_PATH + "graph_formats/";
+        std::filesystem::create_directories(graph_dir);
+        const auto read_file = [](const std::filesystem::path& path) {
+            std::ifstream in(path);
+            return std::string{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+        };
+
+        graph_queue queue;
+        u32 count = 0;
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (const auto* func : da.get_all_functions()) {
+            const auto graph = ControlFlowGraph::build(*func);
+            const std::string name = std::to_string(count++);
+            graph.write_image((graph_dir / (name + ".svg")).string());
+            graph.write_dot((graph_dir / (name + ".dot")).string());
+            queue.push(graph.get_image(), graph_dir / (name + ".async.svg"));
+        }
+        const auto sync_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
+        EXPECT_EQ(queue.render_all(), count);
+        std::cout << count << " graphs, svg & dot: " << sync_time.count() << "us\n";
+
+        for (u32 i = 0; i < count; ++i) {
+            const std::string svg = read_file(graph_dir / (std::to_string(i) + ".svg"));
+            EXPECT_TRUE(svg.starts_with("<svg"));
+            EXPECT_EQ(svg, read_file(graph_dir / (std::to_string(i) + ".async.svg")));
+            EXPECT_TRUE(read_file(graph_dir / (std::to_string(i) + ".dot")).starts_with("digraph G {"));
+        }
+    }
+
+    TEST(DECOMPILER, GraphLayoutLayers) {
+        // 3 is the return node, 4 comes after it in program order and jumps back to it
+        const std::array<layout_point, 5> sizes{ { { 40.f, 20.f }, { 40.f, 20.f }, { 40.f, 20.f }, { 40.f, 20.f }, { 40.f, 20.f } } };
+        const std::array<layout_edge, 5> edges{ { { 0, 1 }, { 0, 2 }, { 1, 3 }, { 2, 4 }, { 4, 3 } } };
+        const graph_layout layout = layout_layered(sizes, edges, 3);
+
+        // layer 2 only holds the dummies of the edges 1 -> 3 and 2 -> 4, so it has no height.
+        // 4 has to stay below the return node after it was moved down, otherwise the edge between them has no direction
+        ASSERT_EQ(layout.m_nodes.size(), 5);
+        EXPECT_EQ(layout.m_nodes[0].m_y, 24.f);
+        EXPECT_EQ(layout.m_nodes[1].m_y, 100.f);
+        EXPECT_EQ(layout.m_nodes[2].m_y, 100.f);
+        EXPECT_EQ(layout.m_nodes[3].m_y, 232.f);
+        EXPECT_EQ(layout.m_nodes[4].m_y, 308.f);
+        EXPECT_LT(layout.m_nodes[1].m_x, layout.m_nodes[2].m_x);
+
+        // the edge 2 -> 4 passes through layers 2 and 3, the edge going up is drawn next to the nodes
+        ASSERT_EQ(layout.m_edges[3].size(), 6);
+        EXPECT_EQ(layout.m_edges[3].front().m_y, 120.f);
+        EXPECT_EQ(layout.m_edges[3].back().m_y, 308.f);
+        EXPECT_EQ(layout.m_edges[4].size(), 4);
     }
 
     TEST(DECOMPILER, FullGame) {
@@ -553,6 +1272,65 @@ namespace dconstruct::testing {
         }
     }
 
+    TEST(DECOMPILER, FullGameCfgBuild) {
+        u64 function_count = 0, node_count = 0;
+        std::chrono::high_resolution_clock::duration build_time{};
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(R"(C:\Program Files (x86)\Steam\steamapps\common\The Last of Us Part II\build\pc\main\bin_unpacked\dc1)")) {
+            if (entry.path().extension() != ".bin") {
+                continue;
+            }
+            auto file_res = BinaryFile::from_path(entry.path());
+            if (!file_res) {
+                std::cerr << file_res.error() << "\n";
+                std::terminate();
+            }
+            auto& file = *file_res;
+            Disassembler da{ &file, &base };
+            da.disassemble();
+            const auto start = std::chrono::high_resolution_clock::now();
+            for (const auto* func : da.get_all_functions()) {
+                const auto graph = ControlFlowGraph::build(*func);
+                node_count += graph.m_nodes.size();
+                ++function_count;
+            }
+            build_time += std::chrono::high_resolution_clock::now() - start;
+        }
+        const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(build_time).count();
+        std::cout << "built " << function_count << " graphs with " << node_count << " nodes in " << duration << "ms\n";
+    }
+
+    TEST(DECOMPILER, FullGameLargestFunctions) {
+        constexpr u32 min_lines = 1000;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(R"(C:\Program Files (x86)\Steam\steamapps\common\The Last of Us Part II\build\pc\main\bin_unpacked\dc1)")) {
+            if (entry.path().extension() != ".bin") {
+                continue;
+            }
+            auto file_res = BinaryFile::from_path(entry.path());
+            if (!file_res) {
+                std::cerr << file_res.error() << "\n";
+                std::terminate();
+            }
+            auto& file = *file_res;
+            Disassembler da{ &file, &base };
+            da.disassemble();
+            for (const auto* func : da.get_all_functions()) {
+                if (func->m_lines.size() < min_lines) {
+                    continue;
+                }
+                try {
+                    const auto start = std::chrono::high_resolution_clock::now();
+                    const auto dc_func = dcompiler::decomp_function{ *func, file, ControlFlowGraph::build(*func) }.decompile(false);
+                    const auto stop = std::chrono::high_resolution_clock::now();
+                    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
+                    std::cout << func->get_id() << " (" << func->m_lines.size() << " lines) took " << duration << "ms\n";
+                }
+                catch (const std::exception& e) {
+                    std::cout << e.what() << '\n';
+                }
+            }
+        }
+    }
+
 
 	
 
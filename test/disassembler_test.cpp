@@ -2,7 +2,12 @@
 #include "binaryfile.h"
 #include "disassembly/file_disassembler.h"
 #include "decompilation/decomp_function.h"
+#include "disassembly/command_line_options.h"
 #include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <bit>
+#include <array>
 
 TEST(SANITY, Basic) {
     EXPECT_STRNE("0", "1");
@@ -12,6 +17,135 @@ namespace dconstruct::testing {
 
     static SIDBase base = *SIDBase::from_binary(R"(C:\Users\damix\Documents\GitHub\TLOU2Modding\dconstruct\test\uc4\sidbase_sorted.bin)");
 
+    // a sidbase that only knows the given names
+    static SIDBase make_sidbase(const std::vector<std::string>& names) {
+        std::vector<std::pair<sid64, std::string>> sorted;
+        for (const auto& name : names) {
+            sorted.emplace_back(SID(name.c_str()), name);
+        }
+        std::ranges::sort(sorted);
+        u64 size = 8 + sorted.size() * sizeof(SIDBaseEntry);
+        for (const auto& [hash, name] : sorted) {
+            size += name.size() + 1;
+        }
+        auto bytes = std::make_unique<std::byte[]>(size);
+        *reinterpret_cast<u64*>(bytes.get()) = sorted.size();
+        auto* entries = reinterpret_cast<SIDBaseEntry*>(bytes.get() + 8);
+        u64 string_offset = 8 + sorted.size() * sizeof(SIDBaseEntry);
+        for (u64 i = 0; i < sorted.size(); ++i) {
+            entries[i] = SIDBaseEntry{ sorted[i].first, string_offset };
+            std::memcpy(bytes.get() + string_offset, sorted[i].second.c_str(), sorted[i].second.size() + 1);
+            string_offset += sorted[i].second.size() + 1;
+        }
+        return SIDBase{ sorted.size(), std::move(bytes), entries, sorted.front().first, sorted.back().first };
+    }
+
+    // lays out a DC file qword by qword behind the header and the entry table. pointers are written as file offsets
+    // and relocated when the file is loaded, string pointers get resolved once the string table is placed.
+    struct test_dc_file {
+        std::vector<u64> m_qwords;
+        std::vector<u64> m_pointerSlots;
+        std::vector<std::pair<u64, std::string>> m_stringSlots;
+        u32 m_numEntries;
+
+        explicit test_dc_file(const u32 num_entries) : m_qwords(4 + num_entries * 3), m_numEntries(num_entries) {
+            m_qwords[3] = 0x20;
+            m_pointerSlots.push_back(0x18);
+        }
+
+        [[nodiscard]] u64 offset() const noexcept {
+            return m_qwords.size() * 8;
+        }
+
+        u64 add(const u64 value) {
+            m_qwords.push_back(value);
+            return offset() - 8;
+        }
+
+        u64 add(const u32 low, const u32 high) {
+            return add(static_cast<u64>(high) << 32 | low);
+        }
+
+        u64 add_pointer(const u64 target) {
+            m_pointerSlots.push_back(offset());
+            return add(target);
+        }
+
+        u64 add_string(const std::string& str) {
+            m_pointerSlots.push_back(offset());
+            m_stringSlots.emplace_back(offset(), str);
+            return add(0);
+        }
+
+        // adds the type ID and returns the offset of the struct's data right behind it
+        u64 add_struct_header(const sid64 type_id) {
+            return add(type_id) + 8;
+        }
+
+        void set_entry(const u32 idx, const sid64 name_id, const sid64 type_id, const u64 data_offset) {
+            const u64 first = 4 + idx * 3;
+            m_qwords[first] = name_id;
+            m_qwords[first + 1] = type_id;
+            m_qwords[first + 2] = data_offset;
+            m_pointerSlots.push_back((first + 2) * 8);
+        }
+
+        [[nodiscard]] std::filesystem::path write(const std::string& filename) const {
+            std::vector<u64> qwords = m_qwords;
+            const u32 strings_offset = static_cast<u32>(offset());
+            std::string strings;
+            for (const auto& [slot, str] : m_stringSlots) {
+                qwords[slot / 8] = strings_offset + strings.size();
+                strings += str;
+                strings += '\0';
+            }
+            strings.resize((strings.size() + 7) & ~7ULL, '\0');
+            const u32 text_size = static_cast<u32>(strings_offset + strings.size());
+            qwords[0] = static_cast<u64>(DC_VERSION) << 32 | DC_MAGIC;
+            qwords[1] = static_cast<u64>(strings_offset) << 32 | text_size;
+            qwords[2] = static_cast<u64>(m_numEntries) << 32 | 1;
+
+            const u32 table_size = (text_size + 63) / 64;
+            std::vector<u8> reloc_table(table_size, 0);
+            for (const u64 slot : m_pointerSlots) {
+                reloc_table[slot / 64] |= 1 << ((slot / 8) % 8);
+            }
+
+            const std::filesystem::path path = std::filesystem::temp_directory_path() / filename;
+            std::ofstream out(path, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(qwords.data()), qwords.size() * 8);
+            out.write(strings.data(), strings.size());
+            out.write(reinterpret_cast<const char*>(&table_size), sizeof(table_size));
+            out.write(reinterpret_cast<const char*>(reloc_table.data()), reloc_table.size());
+            return path;
+        }
+    };
+
+    // keeps the disassembly in memory instead of writing it to a file
+    class StringDisassembler : public Disassembler {
+    public:
+        StringDisassembler(BinaryFile* file, const SIDBase* sidbase, const DisassemblerOptions& options) noexcept : Disassembler(file, sidbase) {
+            m_options = options;
+        }
+
+        std::string m_text;
+
+    private:
+        void insert_span(const char* text, const u32 indent = 0, const TextFormat& text_format = TextFormat{}) override {
+            m_text.append(indent, ' ');
+            m_text += text;
+        }
+    };
+
+    // the disassembly of every entry, without the listing header in front
+    static std::string disassemble_entries(const std::filesystem::path& path, const SIDBase& sidbase, const DisassemblerOptions& options = {}) {
+        BinaryFile file = *BinaryFile::from_path(path);
+        StringDisassembler disassembler{ &file, &sidbase, options };
+        disassembler.disassemble();
+        const std::string& text = disassembler.m_text;
+        return text.substr(text.find("\n\n######"));
+    }
+
 
     TEST(DISASSEMBLER, NonExistingFile) {
         const std::string filepath = "dc_test_files/not_found.bin";
@@ -65,5 +199,417 @@ namespace dconstruct::testing {
 
         ASSERT_GT(dis.get_all_functions().size(), 0);
     }
-}
 
+    TEST(DISASSEMBLER, StructLayoutCache) {
+        const std::vector<member_kind> layout = {member_kind::SID, member_kind::FLOAT, member_kind::I32, member_kind::POINTER};
+        const std::vector<member_kind> other_layout = {member_kind::SID, member_kind::I32, member_kind::I32, member_kind::POINTER};
+
+        StructLayoutCache cache;
+        cache.add_sighting(SID("thing"), layout);
+        cache.add_sighting(SID("thing"), layout);
+        cache.add_sighting(SID("thing"), layout);
+        // layouts confirmed during a run are only used by the next one
+        EXPECT_EQ(cache.get_confirmed(SID("thing")), nullptr);
+        EXPECT_EQ(cache.num_confirmed(), 1);
+
+        // a type that was seen with two layouts is never confirmed, no matter the order
+        StructLayoutCache first_layout_first;
+        StructLayoutCache other_layout_first;
+        for (u32 i = 0; i < StructLayoutCache::REQUIRED_SIGHTINGS; ++i) {
+            first_layout_first.add_sighting(SID("thing"), layout);
+        }
+        first_layout_first.add_sighting(SID("thing"), other_layout);
+        other_layout_first.add_sighting(SID("thing"), other_layout);
+        for (u32 i = 0; i < StructLayoutCache::REQUIRED_SIGHTINGS; ++i) {
+            other_layout_first.add_sighting(SID("thing"), layout);
+        }
+        EXPECT_EQ(first_layout_first.num_confirmed(), 0);
+        EXPECT_EQ(other_layout_first.num_confirmed(), 0);
+
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "dconstruct_layouts.bin";
+        ASSERT_TRUE(cache.save(path).has_value());
+        StructLayoutCache loaded;
+        ASSERT_TRUE(loaded.load(path).has_value());
+        ASSERT_NE(loaded.get_confirmed(SID("thing")), nullptr);
+        EXPECT_EQ(*loaded.get_confirmed(SID("thing")), layout);
+
+        loaded.add_sighting(SID("thing"), other_layout);
+        EXPECT_EQ(*loaded.get_confirmed(SID("thing")), layout);
+
+        ASSERT_TRUE(first_layout_first.save(path).has_value());
+        StructLayoutCache loaded_conflict;
+        ASSERT_TRUE(loaded_conflict.load(path).has_value());
+        EXPECT_EQ(loaded_conflict.get_confirmed(SID("thing")), nullptr);
+        std::filesystem::remove(path);
+    }
+
+    TEST(DISASSEMBLER, StructLayoutCacheBatchOrder) {
+        const SIDBase sidbase = make_sidbase({ "test-struct", "first-member", "entry-0", "entry-1", "entry-2" });
+
+        // three instances with a float in the second member
+        test_dc_file floats{ 3 };
+        for (u32 i = 0; i < 3; ++i) {
+            const u64 data = floats.add_struct_header(SID("test-struct"));
+            floats.add(SID("first-member"));
+            floats.add(std::bit_cast<u32>(1.5f), std::bit_cast<u32>(2.5f));
+            floats.set_entry(i, SID(("entry-" + std::to_string(i)).c_str()), SID("test-struct"), data);
+        }
+        const std::filesystem::path floats_path = floats.write("dconstruct_layout_floats.bin");
+
+        // one instance with an int there instead
+        test_dc_file ints{ 1 };
+        const u64 data = ints.add_struct_header(SID("test-struct"));
+        ints.add(SID("first-member"));
+        ints.add(5, std::bit_cast<u32>(2.5f));
+        ints.set_entry(0, SID("entry-0"), SID("test-struct"), data);
+        const std::filesystem::path ints_path = ints.write("dconstruct_layout_ints.bin");
+
+        const std::string expected_ints =
+            "\n\n##############################  ENTRY 0  ##############################\n\n"
+            "entry-0 = test-struct [0x00040] {\n"
+            "  [0] sid: first-member\n"
+            "  [1] int: 5\n"
+            "  [2] float: 2.50\n"
+            "}\n";
+
+        // within a run the cache doesn't change how anything is decoded, so the other file of the batch doesn't matter
+        StructLayoutCache alone_cache;
+        const std::string alone = disassemble_entries(ints_path, sidbase, DisassemblerOptions{ .m_layoutCache = &alone_cache });
+        EXPECT_EQ(alone, expected_ints);
+
+        StructLayoutCache batch_cache;
+        disassemble_entries(floats_path, sidbase, DisassemblerOptions{ .m_layoutCache = &batch_cache });
+        EXPECT_EQ(disassemble_entries(ints_path, sidbase, DisassemblerOptions{ .m_layoutCache = &batch_cache }), alone);
+        EXPECT_EQ(batch_cache.m_cachedInstances, 0);
+
+        // a later run decodes the instance with the layout the first file confirmed
+        StructLayoutCache floats_cache;
+        disassemble_entries(floats_path, sidbase, DisassemblerOptions{ .m_layoutCache = &floats_cache });
+        const std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "dconstruct_batch_layouts.bin";
+        ASSERT_TRUE(floats_cache.save(cache_path).has_value());
+        StructLayoutCache next_run;
+        ASSERT_TRUE(next_run.load(cache_path).has_value());
+        const std::string cached = disassemble_entries(ints_path, sidbase, DisassemblerOptions{ .m_layoutCache = &next_run, .m_validateLayouts = true });
+        const std::string expected_cached =
+            "\n\n##############################  ENTRY 0  ##############################\n\n"
+            "entry-0 = test-struct [0x00040] {\n"
+            "  [0] sid: first-member\n"
+            "  [1] float: 0.00\n"
+            "  (cached as float, but looks like int)\n"
+            "  [2] float: 2.50\n"
+            "}\n";
+        EXPECT_EQ(cached, expected_cached);
+        EXPECT_EQ(next_run.m_cachedInstances, 1);
+
+        std::filesystem::remove(cache_path);
+        std::filesystem::remove(floats_path);
+        std::filesystem::remove(ints_path);
+    }
+
+    TEST(DISASSEMBLER, StructTableOutput) {
+        // the same text the disassembler printed before it had a struct table, covering typed and untyped pointer targets,
+        // an array that ends at the next struct's type ID and one that runs into the string table
+        const SIDBase sidbase = make_sidbase({ "array", "test-struct", "test-entry", "first-member", "second-member", "entry-0", "entry-1" });
+        test_dc_file dc{ 2 };
+        // a typed struct, an array and an untyped array, all pointed at from the first entry
+        const u64 typed = dc.add_struct_header(SID("test-entry"));
+        dc.add(1, 2);
+        dc.add(std::bit_cast<u32>(1.5f), std::bit_cast<u32>(2.5f));
+        const u64 array = dc.add_struct_header(SID("array"));
+        dc.add(SID("first-member"));
+        dc.add(SID("second-member"));
+        dc.add(SID("first-member"));
+        // not a sid, so the array behind it has no type ID
+        dc.add(7, 0);
+        const u64 untyped = dc.add(SID("second-member"));
+        dc.add(SID("first-member"));
+
+        const u64 first = dc.add_struct_header(SID("test-struct"));
+        dc.add(SID("first-member"));
+        dc.add_pointer(typed);
+        dc.add_pointer(array);
+        dc.add(3);
+        dc.add_pointer(untyped);
+        dc.add(2);
+        dc.add_string("name");
+
+        // the last array runs into the string table, whose first string is pointed at
+        const u64 second = dc.add_struct_header(SID("test-struct"));
+        dc.add(SID("second-member"));
+        const u64 last_array_slot = dc.add_pointer(0);
+        dc.add(2);
+        const u64 last_array = dc.add_struct_header(SID("array"));
+        dc.add(SID("second-member"));
+        dc.add(SID("first-member"));
+        dc.m_qwords[last_array_slot / 8] = last_array;
+
+        dc.set_entry(0, SID("entry-0"), SID("test-struct"), first);
+        dc.set_entry(1, SID("entry-1"), SID("test-struct"), second);
+        const std::filesystem::path path = dc.write("dconstruct_struct_table.bin");
+
+        const std::string expected =
+            "\n\n##############################  ENTRY 0  ##############################\n\n"
+            "entry-0 = test-struct [0x000A8] {\n"
+            "  [0] sid: first-member\n"
+            "  [1] test-entry [0x00058] {\n"
+            "    [0] int: 1\n"
+            "    [1] int: 2\n"
+            "    [2] float: 1.50\n"
+            "    [3] float: 2.50\n"
+            "  }\n"
+            "  [2] array [0xb8] {size: 3} {\n"
+            "    [0] anonymous struct [0x00070] {\n"
+            "      [0] sid: first-member\n"
+            "    }\n"
+            "    [1] anonymous struct [0x00078] {\n"
+            "      [0] sid: second-member\n"
+            "    }\n"
+            "    [2] anonymous struct [0x00080] {\n"
+            "      [0] sid: first-member\n"
+            "    }\n"
+            "  }\n"
+            "  [3] int: 3\n"
+            "  [4] int: 0\n"
+            "  [5] anonymous array [0xc8] {size: 2} {\n"
+            "    [0] anonymous struct [0x00090] {\n"
+            "      [0] sid: second-member\n"
+            "    }\n"
+            "    [1] anonymous struct [0x00098] {\n"
+            "      [0] sid: first-member\n"
+            "    }\n"
+            "  }\n"
+            "  [6] int: 2\n"
+            "  [7] int: 0\n"
+            "  [8] string: \"name\"\n"
+            "}\n"
+            "\n\n##############################  ENTRY 1  ##############################\n\n"
+            "entry-1 = test-struct [0x000E8] {\n"
+            "  [0] sid: second-member\n"
+            "  [1] array [0xf0] {size: 2} {\n"
+            "    [0] anonymous struct [0x00108] {\n"
+            "      [0] sid: second-member\n"
+            "    }\n"
+            "    [1] anonymous struct [0x00110] {\n"
+            "      [0] sid: first-member\n"
+            "    }\n"
+            "  }\n"
+            "  [2] int: 2\n"
+            "  [3] int: 0\n"
+            "}\n";
+        EXPECT_EQ(disassemble_entries(path, sidbase), expected);
+        std::filesystem::remove(path);
+    }
+
+    TEST(DISASSEMBLER, EmitOnceStructBackReference) {
+        const SIDBase sidbase = make_sidbase({ "test-struct", "entry-0", "entry-1" });
+
+        // two structs of the same type with the same 32 bytes of contents
+        test_dc_file dc{ 2 };
+        for (u32 i = 0; i < 2; ++i) {
+            const u64 data = dc.add_struct_header(SID("test-struct"));
+            dc.add(1, 2);
+            dc.add(3, 4);
+            dc.add(5, 6);
+            dc.add(7, 8);
+            dc.set_entry(i, SID(("entry-" + std::to_string(i)).c_str()), SID("test-struct"), data);
+        }
+        const std::filesystem::path path = dc.write("dconstruct_struct_backref.bin");
+
+        const std::string expected =
+            "\n\n##############################  ENTRY 0  ##############################\n\n"
+            "entry-0 = test-struct [0x00058] {\n"
+            "  [0] int: 1\n"
+            "  [1] int: 2\n"
+            "  [2] int: 3\n"
+            "  [3] int: 4\n"
+            "  [4] int: 5\n"
+            "  [5] int: 6\n"
+            "  [6] int: 7\n"
+            "  [7] int: 8\n"
+            "}\n"
+            "\n\n##############################  ENTRY 1  ##############################\n\n"
+            "entry-1 = test-struct [0x00080] {\n"
+            "  ALREADY EMITTED AS [0x00058]\n"
+            "}\n";
+        EXPECT_EQ(disassemble_entries(path, sidbase, DisassemblerOptions{ .m_emitOnce = true }), expected);
+        std::filesystem::remove(path);
+    }
+
+    TEST(DISASSEMBLER, EmitOnceArrayBackReference) {
+        const SIDBase sidbase = make_sidbase({ "array", "test-struct", "first-member", "second-member", "entry-0", "entry-1" });
+
+        // two structs that each point at their own array, both arrays hold the same 32 bytes
+        test_dc_file dc{ 2 };
+        std::array<u64, 2> arrays;
+        for (u32 i = 0; i < 2; ++i) {
+            arrays[i] = dc.add_struct_header(SID("array"));
+            dc.add(SID("first-member"));
+            dc.add(SID("second-member"));
+            dc.add(SID("second-member"));
+            dc.add(SID("first-member"));
+        }
+        for (u32 i = 0; i < 2; ++i) {
+            const u64 data = dc.add_struct_header(SID("test-struct"));
+            dc.add_pointer(arrays[i]);
+            dc.add(2);
+            dc.set_entry(i, SID(("entry-" + std::to_string(i)).c_str()), SID("test-struct"), data);
+        }
+        const std::filesystem::path path = dc.write("dconstruct_array_backref.bin");
+
+        const std::string expected =
+            "\n\n##############################  ENTRY 0  ##############################\n\n"
+            "entry-0 = test-struct [0x000A8] {\n"
+            "  [0] array [0xa8] {size: 2} {\n"
+            "    [0] anonymous struct [0x00058] {\n"
+            "      [0] sid: first-member\n"
+            "      [1] sid: second-member\n"
+            "    }\n"
+            "    [1] anonymous struct [0x00068] {\n"
+            "      [0] sid: second-member\n"
+            "      [1] sid: first-member\n"
+            "    }\n"
+            "  }\n"
+            "  [1] int: 2\n"
+            "  [2] int: 0\n"
+            "}\n"
+            "\n\n##############################  ENTRY 1  ##############################\n\n"
+            "entry-1 = test-struct [0x000C0] {\n"
+            "  [0] array [0xc0] {size: 2} {\n"
+            "    ALREADY EMITTED AS [0x00058]\n"
+            "  }\n"
+            "  [1] int: 2\n"
+            "  [2] int: 0\n"
+            "}\n";
+        EXPECT_EQ(disassemble_entries(path, sidbase, DisassemblerOptions{ .m_emitOnce = true }), expected);
+        std::filesystem::remove(path);
+    }
+
+    TEST(DISASSEMBLER, StructKindLookup) {
+        EXPECT_EQ(get_struct_kind(SID("state-script")), struct_kind::STATE_SCRIPT);
+        EXPECT_EQ(get_struct_kind(SID("script-lambda")), struct_kind::SCRIPT_LAMBDA);
+        EXPECT_EQ(get_struct_kind(SID("map")), struct_kind::MAP);
+        EXPECT_EQ(get_struct_kind(SID("map-32")), struct_kind::MAP);
+        EXPECT_EQ(get_struct_kind(SID("array")), struct_kind::ARRAY);
+        EXPECT_EQ(get_struct_kind(SID("point-curve")), struct_kind::POINT_CURVE);
+        EXPECT_EQ(get_struct_kind(SID("symbol-array")), struct_kind::SYMBOL_ARRAY);
+
+        EXPECT_EQ(get_struct_kind(SID("symbol")), struct_kind::UNMAPPED);
+        EXPECT_EQ(get_struct_kind(SID("vector")), struct_kind::UNMAPPED);
+        EXPECT_EQ(get_struct_kind(0), struct_kind::UNMAPPED);
+
+        EXPECT_FALSE(get_struct_kind_entry(SID("state-script")).m_editable);
+        EXPECT_FALSE(get_struct_kind_entry(SID("script-lambda")).m_editable);
+        EXPECT_TRUE(get_struct_kind_entry(SID("symbol-array")).m_editable);
+        EXPECT_TRUE(get_struct_kind_entry(SID("vector")).m_editable);
+    }
+
+    TEST(DISASSEMBLER, StructKindSlots) {
+        std::array<bool, STRUCT_DISPATCH_SIZE> used{};
+        for (const auto& entry : STRUCT_KINDS) {
+            const u64 slot = get_struct_dispatch_slot(entry.m_typeId);
+            ASSERT_LT(slot, STRUCT_DISPATCH_SIZE);
+            EXPECT_FALSE(used[slot]);
+            used[slot] = true;
+            EXPECT_EQ(&get_struct_kind_entry(entry.m_typeId), &STRUCT_DISPATCH_TABLE[slot]);
+        }
+    }
+
+    TEST(DISASSEMBLER, PointCurveRenderer) {
+        const SIDBase sidbase = make_sidbase({ "point-curve", "test-struct", "entry-0", "entry-1" });
+
+        // a point curve of exactly sizeof(structs::point_curve) and one a qword short of it, which is printed like any other struct
+        test_dc_file dc{ 2 };
+        const u64 curve = dc.add_struct_header(SID("point-curve"));
+        dc.add(3, std::bit_cast<u32>(0.0f));
+        for (u32 i = 1; i < 33; i += 2) {
+            dc.add(std::bit_cast<u32>(i * 0.25f), std::bit_cast<u32>((i + 1) * 0.25f));
+        }
+        const u64 short_curve = dc.add_struct_header(SID("point-curve"));
+        dc.add(1, std::bit_cast<u32>(0.5f));
+        dc.add(std::bit_cast<u32>(1.5f), std::bit_cast<u32>(2.5f));
+        dc.set_entry(0, SID("entry-0"), SID("point-curve"), curve);
+        dc.set_entry(1, SID("entry-1"), SID("point-curve"), short_curve);
+        const std::filesystem::path path = dc.write("dconstruct_point_curve.bin");
+
+        std::string expected =
+            "\n\n##############################  ENTRY 0  ##############################\n\n"
+            "entry-0 = point-curve [0x00058] {\n"
+            "  [0] int: 3\n";
+        const char* floats[33] = {
+            "0.00", "0.25", "0.50", "0.75", "1.00", "1.25", "1.50", "1.75", "2.00", "2.25", "2.50",
+            "2.75", "3.00", "3.25", "3.50", "3.75", "4.00", "4.25", "4.50", "4.75", "5.00", "5.25",
+            "5.50", "5.75", "6.00", "6.25", "6.50", "6.75", "7.00", "7.25", "7.50", "7.75", "8.00",
+        };
+        for (u32 i = 0; i < 33; ++i) {
+            expected += "  [" + std::to_string(i + 1) + "] float: " + floats[i] + "\n";
+        }
+        expected +=
+            "}\n"
+            "\n\n##############################  ENTRY 1  ##############################\n\n"
+            "entry-1 = point-curve [0x000E8] {\n"
+            "  [0] int: 1\n"
+            "  [1] float: 0.50\n"
+            "  [2] float: 1.50\n"
+            "  [3] float: 2.50\n"
+            "}\n";
+        EXPECT_EQ(disassemble_entries(path, sidbase), expected);
+        std::filesystem::remove(path);
+    }
+
+    TEST(DISASSEMBLER, SymbolArrayRenderer) {
+        const SIDBase sidbase = make_sidbase({ "symbol-array", "array", "entry-0", "first-symbol", "second-symbol", "third-symbol" });
+
+        // the keys live in their own array behind the symbol array, like they do in the game's files
+        test_dc_file dc{ 1 };
+        const u64 symbols = dc.add_struct_header(SID("symbol-array"));
+        dc.add(3);
+        const u64 keys_slot = dc.add_pointer(0);
+        const u64 keys = dc.add_struct_header(SID("array"));
+        dc.add(SID("first-symbol"));
+        dc.add(SID("second-symbol"));
+        dc.add(SID("third-symbol"));
+        dc.m_qwords[keys_slot / 8] = keys;
+        dc.set_entry(0, SID("entry-0"), SID("symbol-array"), symbols);
+        const std::filesystem::path path = dc.write("dconstruct_symbol_array.bin");
+
+        const std::string expected =
+            "\n\n##############################  ENTRY 0  ##############################\n\n"
+            "entry-0 = symbol-array [0x00040] {\n"
+            "  symbols: [0x00058]\n"
+            "  [0] symbol: first-symbol\n"
+            "  [1] symbol: second-symbol\n"
+            "  [2] symbol: third-symbol\n"
+            "}\n";
+        EXPECT_EQ(disassemble_entries(path, sidbase), expected);
+        std::filesystem::remove(path);
+    }
+
+    static std::optional<std::pair<cxxopts::Options, cxxopts::ParseResult>> parse_args(std::vector<std::string> args) {
+        std::vector<char*> argv;
+        for (auto& arg : args) {
+            argv.push_back(arg.data());
+        }
+        return disassembly::get_command_line_options(static_cast<int>(argv.size()), argv.data());
+    }
+
+    TEST(DISASSEMBLER, GraphsOptionFormat) {
+        const auto separate = parse_args({ "dconstruct", "--graphs", "dot", "ss-test.bin" });
+        ASSERT_TRUE(separate);
+        EXPECT_EQ(separate->second["graphs"].as<std::string>(), "dot");
+        EXPECT_EQ(separate->second["i"].as<std::string>(), "ss-test.bin");
+
+        const auto joined = parse_args({ "dconstruct", "ss-test.bin", "--graphs=svg-async" });
+        ASSERT_TRUE(joined);
+        EXPECT_EQ(joined->second["graphs"].as<std::string>(), "svg-async");
+        EXPECT_EQ(joined->second["i"].as<std::string>(), "ss-test.bin");
+
+        const auto bare = parse_args({ "dconstruct", "--graphs", "ss-test.bin" });
+        ASSERT_TRUE(bare);
+        EXPECT_EQ(bare->second["graphs"].as<std::string>(), "svg");
+        EXPECT_EQ(bare->second["i"].as<std::string>(), "ss-test.bin");
+
+        const auto bare_last = parse_args({ "dconstruct", "ss-test.bin", "--graphs" });
+        ASSERT_TRUE(bare_last);
+        EXPECT_EQ(bare_last->second["graphs"].as<std::string>(), "svg");
+    }
+}